@@ -0,0 +1,128 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+
+enum class HugePages {
+    /** 系统不支持大页, 大块内存退化为按2MB对齐的普通页 */
+    None,
+    /** 透明大页(THP), 对分配的区间调用madvise(MADV_HUGEPAGE) */
+    Transparent,
+    /** THP被关闭, 尝试使用预留的hugetlbfs页(MAP_HUGETLB) */
+    HugeTlb
+};
+
+/**
+ * 检查当前系统可以使用的大页方式, 只检查一次
+ * @return
+ */
+inline HugePages huge_page_support() {
+    static const HugePages support = [] {
+#ifdef __linux__
+        std::ifstream thp("/sys/kernel/mm/transparent_hugepage/enabled");
+        std::string mode;
+        if (std::getline(thp, mode) && mode.find("[never]") == std::string::npos) return HugePages::Transparent;
+#ifdef MAP_HUGETLB
+        std::ifstream nr("/proc/sys/vm/nr_hugepages");
+        size_t pages = 0;
+        if (nr >> pages && pages != 0) return HugePages::HugeTlb;
+#endif
+#endif
+        return HugePages::None;
+    }();
+    return support;
+}
+
+/**
+ * 按缓存行对齐的分配器, 大块内存按2MB对齐并使用大页, 减少随机访问时的TLB缺失
+ * 1. 小于HugeThreshold字节: operator new, 按Align对齐(默认64字节, 一条缓存行/一个AVX-512向量)
+ * 2. 不小于HugeThreshold字节: mmap一段按2MB对齐的区间, 长度向上取整到2MB,
+ *    优先madvise(MADV_HUGEPAGE)使用透明大页, THP关闭时尝试MAP_HUGETLB, 都不可用时就是普通页
+ * 与@code{Vectors}一起使用时, @code{Vectors::alignment}等于Align, kernels据此省去对齐的前导循环
+ * @tparam T
+ * @tparam Align 2的幂, 不小于alignof(T)时生效
+ * @tparam HugeThreshold 使用大页的最小字节数, 传SIZE_MAX关闭大页
+ */
+template<class T, size_t Align = 64, size_t HugeThreshold = size_t(4) << 20>
+class AlignedAllocator {
+    static_assert((Align & (Align - 1)) == 0, "alignment must be a power of two");
+public:
+    using value_type = T;
+
+    static constexpr size_t alignment = Align > alignof(T) ? Align : alignof(T);
+    static constexpr size_t huge_page_size = size_t(2) << 20;
+
+    template<class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align, HugeThreshold>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template<class U>
+    AlignedAllocator(AlignedAllocator<U, Align, HugeThreshold> const&) noexcept {};
+
+    [[nodiscard]] T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (!S_is_huge(bytes)) return static_cast<T *>(::operator new(bytes, std::align_val_t(alignment)));
+        return static_cast<T *>(S_map_huge(S_round_to_huge(bytes)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        size_t bytes = n * sizeof(T);
+        if (!S_is_huge(bytes)) {
+            ::operator delete(p, bytes, std::align_val_t(alignment));
+            return;
+        }
+        munmap(p, S_round_to_huge(bytes));
+    }
+
+    template<class U>
+    bool operator==(AlignedAllocator<U, Align, HugeThreshold> const&) const noexcept {
+        return true;
+    }
+
+private:
+    static bool S_is_huge(size_t bytes) noexcept {
+        return bytes >= HugeThreshold;
+    }
+
+    static size_t S_round_to_huge(size_t bytes) noexcept {
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+
+    /**
+     * 申请len字节(2MB的整数倍), 起始地址按2MB对齐
+     * @param len
+     * @return
+     */
+    static void* S_map_huge(size_t len) {
+        HugePages support = huge_page_support();
+#ifdef MAP_HUGETLB
+        if (support == HugePages::HugeTlb) {
+            void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            // 预留的大页用完时退化为普通页
+            if (p != MAP_FAILED) return p;
+        }
+#endif
+        // 多申请2MB, 再把首尾不对齐的部分还回去
+        void* raw = mmap(nullptr, len + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) throw std::bad_alloc();
+        auto begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + huge_page_size - 1) / huge_page_size * huge_page_size;
+        size_t head = aligned - begin, tail = huge_page_size - head;
+        if (head != 0) munmap(raw, head);
+        if (tail != 0) munmap(reinterpret_cast<void *>(aligned + len), tail);
+
+        auto p = reinterpret_cast<void *>(aligned);
+#ifdef MADV_HUGEPAGE
+        if (support == HugePages::Transparent) madvise(p, len, MADV_HUGEPAGE);
+#endif
+        return p;
+    }
+};
@@ -0,0 +1,56 @@
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+
+#include "alignedAllocator.hpp"
+#include "../vectors/vectors.hpp"
+
+/**
+ * 随机gather: 在一个远大于TLB覆盖范围的数组中按随机下标读取
+ * 下标由xorshift在寄存器中生成, 不额外占用内存和TLB
+ * 普通4KB页时几乎每次访问都会TLB缺失, 2MB大页时页表遍历大幅减少
+ */
+template<class Alloc>
+double bench(char const* name, size_t n, size_t gathers) {
+    Vectors<uint64_t, Alloc> data(n, default_init);
+    for (size_t i = 0; i < n; i++) {
+        data[i] = i;
+    }
+    size_t mask = n - 1;
+    uint64_t state = 88172645463325252ULL, sink = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < gathers; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        sink += data[state & mask];
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / gathers;
+    std::cout << std::left << std::setw(28) << name
+              << "ns/gather: " << std::setw(10) << ns
+              << "Mgathers/s: " << std::setw(10) << 1e3 / ns
+              << "(checksum " << sink % 1000 << ")" << std::endl;
+    return ns;
+}
+
+int main(int argc, char** argv) {
+    /* 默认1GB的uint64_t, 必须是2的幂 */
+    size_t mb = argc > 1 ? std::stoull(argv[1]) : 1024;
+    size_t n = std::bit_floor(mb * (size_t(1) << 20) / sizeof(uint64_t));
+    size_t gathers = size_t(1) << 24;
+    char const* names[] = {"none", "transparent", "hugetlb"};
+    std::cout << "array: " << n * sizeof(uint64_t) / (1 << 20) << " MB, gathers: " << gathers
+              << ", huge page support: " << names[static_cast<int>(huge_page_support())] << std::endl;
+    std::cout << "-----------------------------" << std::endl;
+
+    bench<std::allocator<uint64_t>>("std::allocator", n, gathers);
+    double small = bench<AlignedAllocator<uint64_t, 64, SIZE_MAX>>("aligned 64B, 4KB pages", n, gathers);
+    double huge = bench<AlignedAllocator<uint64_t>>("aligned 64B, 2MB pages", n, gathers);
+    std::cout << "huge page speedup: " << small / huge << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "alignedAllocator.hpp"
+#include "../vectors/vectors.hpp"
+#include "../vectors/kernels.hpp"
+
+/**
+ * 当前进程中由透明大页提供的内存, 单位kB
+ */
+size_t anon_huge_kb() {
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string key;
+    size_t kb = 0;
+    while (smaps >> key) {
+        if (key == "AnonHugePages:") {
+            smaps >> kb;
+            break;
+        }
+    }
+    return kb;
+}
+
+int main() {
+    static_assert(Vectors<float, AlignedAllocator<float>>::alignment == 64);
+    static_assert(Vectors<float, AlignedAllocator<float, 128>>::alignment == 128);
+    static_assert(Vectors<int>::alignment == alignof(int));
+
+    /* 小块按缓存行对齐, 每次扩容之后都成立 */
+    {
+        Vectors<int32_t, AlignedAllocator<int32_t>> samples;
+        for (int i = 0; i < 10000; i++) {
+            samples.push_back(i);
+            assert(reinterpret_cast<uintptr_t>(samples.data()) % 64 == 0);
+        }
+        assert(kernels::sum(samples) == 49995000);
+        assert(kernels::find(samples, 9999) == 9999);
+        std::cout << "cache-line aligned: " << samples.size() << " ints" << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 大块按2MB对齐, 系统支持时使用大页 */
+    {
+        char const* names[] = {"none", "transparent", "hugetlb"};
+        std::cout << "huge page support: " << names[static_cast<int>(huge_page_support())] << std::endl;
+
+        constexpr size_t n = size_t(8) << 20;
+        Vectors<uint64_t, AlignedAllocator<uint64_t>> big(n);
+        assert(reinterpret_cast<uintptr_t>(big.data()) % AlignedAllocator<uint64_t>::huge_page_size == 0);
+        for (size_t i = 0; i < n; i++) {
+            big[i] = i;
+        }
+        big.push_back(n);
+        assert(reinterpret_cast<uintptr_t>(big.data()) % AlignedAllocator<uint64_t>::huge_page_size == 0);
+        assert(big[n] == n && big[12345] == 12345);
+        std::cout << "AnonHugePages: " << anon_huge_kb() << " kB" << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+    return 0;
+}
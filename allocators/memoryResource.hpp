@@ -0,0 +1,318 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+/**
+ * 内存资源的抽象基类, 与std::pmr::memory_resource类似
+ * 不同的资源(arena, pool, ...)共用同一个@code{PolymorphicAllocator<T>}类型
+ */
+class MemoryResource {
+public:
+    MemoryResource() = default;
+    MemoryResource(MemoryResource const&) = default;
+    MemoryResource& operator=(MemoryResource const&) = default;
+    virtual ~MemoryResource() = default;
+
+    [[nodiscard]] void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) {
+        return do_allocate(bytes, align);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t align = alignof(std::max_align_t)) {
+        do_deallocate(p, bytes, align);
+    }
+
+    [[nodiscard]] bool is_equal(MemoryResource const& that) const noexcept {
+        return this == &that || do_is_equal(that);
+    }
+
+protected:
+    virtual void* do_allocate(size_t bytes, size_t align) = 0;
+    virtual void do_deallocate(void* p, size_t bytes, size_t align) = 0;
+    [[nodiscard]] virtual bool do_is_equal(MemoryResource const& that) const noexcept {
+        return this == &that;
+    }
+};
+
+/**
+ * 直接转发给全局的operator new/delete
+ */
+class NewDeleteResource : public MemoryResource {
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        return ::operator new(bytes, std::align_val_t(align));
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        ::operator delete(p, bytes, std::align_val_t(align));
+    }
+};
+
+/**
+ * 所有资源默认的上游
+ * @return
+ */
+inline MemoryResource* default_resource() noexcept {
+    static NewDeleteResource resource;
+    return &resource;
+}
+
+/**
+ * 单调递增的arena: 分配只移动指针, deallocate什么都不做,
+ * 所有内存在@code{release()}或析构时一次性归还给上游
+ * 适合生命周期相同的一批临时对象, 例如一次请求中的所有scratch向量
+ */
+class MonotonicArena : public MemoryResource {
+private:
+    /** 每一块内存的头部, 串成单向链表以便release */
+    struct Chunk {
+        Chunk* next;
+        size_t bytes;
+    };
+
+    MemoryResource* m_upstream;
+    Chunk* m_chunks;
+
+    /** 用户提供的初始缓冲区, 不归arena释放 */
+    std::byte* m_initial_buffer;
+    size_t m_initial_size;
+
+    std::byte* m_cur;
+    std::byte* m_end;
+    size_t m_next_size;
+
+public:
+    explicit MonotonicArena(size_t initial_size = 1024, MemoryResource* upstream = default_resource()) noexcept
+    : m_upstream(upstream), m_chunks(nullptr), m_initial_buffer(nullptr), m_initial_size(0),
+      m_cur(nullptr), m_end(nullptr), m_next_size(std::max<size_t>(initial_size, 64)) {};
+
+    /**
+     * 先从buffer(例如栈上的数组)中分配, 用完之后才向上游申请
+     * @param buffer
+     * @param size
+     * @param upstream
+     */
+    MonotonicArena(void* buffer, size_t size, MemoryResource* upstream = default_resource()) noexcept
+    : m_upstream(upstream), m_chunks(nullptr),
+      m_initial_buffer(static_cast<std::byte *>(buffer)), m_initial_size(size),
+      m_cur(m_initial_buffer), m_end(m_initial_buffer + size), m_next_size(std::max<size_t>(size, 64)) {};
+
+    MonotonicArena(MonotonicArena const&) = delete;
+    MonotonicArena& operator=(MonotonicArena const&) = delete;
+
+    ~MonotonicArena() override { release(); }
+
+    /**
+     * 一次性归还所有内存, 之前分配出去的指针全部失效
+     */
+    void release() noexcept {
+        while (m_chunks != nullptr) {
+            Chunk* next = m_chunks->next;
+            m_upstream->deallocate(m_chunks, m_chunks->bytes, alignof(std::max_align_t));
+            m_chunks = next;
+        }
+        m_cur = m_initial_buffer;
+        m_end = m_initial_buffer + m_initial_size;
+    }
+
+    [[nodiscard]] MemoryResource* upstream_resource() const noexcept {
+        return m_upstream;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        void* p = M_bump(bytes, align);
+        if (p != nullptr) [[likely]] return p;
+
+        /* 当前块不够用, 申请一个新块, 块的大小按几何级数增长 */
+        size_t need = sizeof(Chunk) + bytes + align;
+        size_t chunk_bytes = std::max(m_next_size, need);
+        auto* chunk = static_cast<Chunk *>(m_upstream->allocate(chunk_bytes, alignof(std::max_align_t)));
+        chunk->next = m_chunks;
+        chunk->bytes = chunk_bytes;
+        m_chunks = chunk;
+        m_cur = reinterpret_cast<std::byte *>(chunk + 1);
+        m_end = reinterpret_cast<std::byte *>(chunk) + chunk_bytes;
+        m_next_size = chunk_bytes * 2;
+        return M_bump(bytes, align);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+private:
+    void* M_bump(size_t bytes, size_t align) noexcept {
+        if (m_cur == nullptr) return nullptr;
+        auto addr = reinterpret_cast<uintptr_t>(m_cur);
+        uintptr_t aligned = (addr + align - 1) & ~(uintptr_t(align) - 1);
+        if (aligned + bytes > reinterpret_cast<uintptr_t>(m_end)) return nullptr;
+        m_cur = reinterpret_cast<std::byte *>(aligned + bytes);
+        return reinterpret_cast<void *>(aligned);
+    }
+};
+
+/**
+ * 按大小分级的内存池: 8, 16, 32 ... 4096字节各有一条空闲链表,
+ * 同一级的块从上游成批申请, deallocate时放回空闲链表, 不会还给上游
+ * 超过最大级别的请求直接转发给上游
+ */
+class PoolResource : public MemoryResource {
+private:
+    static constexpr size_t kMinShift = 3;
+    static constexpr size_t kMaxShift = 12;
+    static constexpr size_t kClasses = kMaxShift - kMinShift + 1;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Chunk {
+        Chunk* next;
+        size_t bytes;
+        size_t align;
+    };
+
+    struct SizeClass {
+        FreeBlock* free_list = nullptr;
+        size_t blocks_per_chunk = 16;
+    };
+
+    MemoryResource* m_upstream;
+    Chunk* m_chunks;
+    SizeClass m_classes[kClasses];
+
+public:
+    explicit PoolResource(MemoryResource* upstream = default_resource()) noexcept
+    : m_upstream(upstream), m_chunks(nullptr) {};
+
+    PoolResource(PoolResource const&) = delete;
+    PoolResource& operator=(PoolResource const&) = delete;
+
+    ~PoolResource() override { release(); }
+
+    /**
+     * 归还所有成批申请的内存
+     */
+    void release() noexcept {
+        while (m_chunks != nullptr) {
+            Chunk* next = m_chunks->next;
+            m_upstream->deallocate(m_chunks, m_chunks->bytes, m_chunks->align);
+            m_chunks = next;
+        }
+        for (auto& cls: m_classes) {
+            cls = SizeClass{};
+        }
+    }
+
+    [[nodiscard]] MemoryResource* upstream_resource() const noexcept {
+        return m_upstream;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        size_t index = M_class_index(bytes, align);
+        if (index >= kClasses) return m_upstream->allocate(bytes, align);
+
+        SizeClass& cls = m_classes[index];
+        if (cls.free_list == nullptr) M_refill(index);
+        FreeBlock* block = cls.free_list;
+        cls.free_list = block->next;
+        return block;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        size_t index = M_class_index(bytes, align);
+        if (index >= kClasses) {
+            m_upstream->deallocate(p, bytes, align);
+            return;
+        }
+        auto* block = static_cast<FreeBlock *>(p);
+        block->next = m_classes[index].free_list;
+        m_classes[index].free_list = block;
+    }
+
+private:
+    /**
+     * 找到能同时满足大小和对齐要求的最小级别
+     * 级别的大小都是2的幂并且块按大小对齐, 所以对齐要求不超过块大小时自然满足
+     */
+    static size_t M_class_index(size_t bytes, size_t align) noexcept {
+        size_t size = std::max({bytes, align, size_t(1) << kMinShift});
+        size_t shift = kMinShift;
+        while ((size_t(1) << shift) < size) shift++;
+        return shift - kMinShift;
+    }
+
+    void M_refill(size_t index) {
+        SizeClass& cls = m_classes[index];
+        size_t block_size = size_t(1) << (index + kMinShift);
+        /* 头部向上取整到块大小, 保证每个块都按块大小对齐 */
+        size_t header = (sizeof(Chunk) + block_size - 1) / block_size * block_size;
+        size_t chunk_bytes = header + block_size * cls.blocks_per_chunk;
+        size_t chunk_align = std::max(block_size, alignof(std::max_align_t));
+
+        auto* chunk = static_cast<Chunk *>(m_upstream->allocate(chunk_bytes, chunk_align));
+        chunk->next = m_chunks;
+        chunk->bytes = chunk_bytes;
+        chunk->align = chunk_align;
+        m_chunks = chunk;
+
+        std::byte* first = reinterpret_cast<std::byte *>(chunk) + header;
+        for (size_t i = cls.blocks_per_chunk; i > 0; i--) {
+            auto* block = reinterpret_cast<FreeBlock *>(first + (i - 1) * block_size);
+            block->next = cls.free_list;
+            cls.free_list = block;
+        }
+        /* 下一次成批申请的块数翻倍, 上限为每块1024个 */
+        cls.blocks_per_chunk = std::min<size_t>(cls.blocks_per_chunk * 2, 1024);
+    }
+};
+
+/**
+ * 持有一个@code{MemoryResource*}的分配器, 可以作为@code{Vectors}, @code{Sets}等容器的Alloc参数
+ * 使用不同资源的容器类型相同, 可以互相赋值和交换
+ * @tparam T
+ */
+template<class T>
+class PolymorphicAllocator {
+private:
+    MemoryResource* m_resource;
+
+    template<class>
+    friend class PolymorphicAllocator;
+
+public:
+    using value_type = T;
+
+    PolymorphicAllocator() noexcept : m_resource(default_resource()) {};
+
+    PolymorphicAllocator(MemoryResource* resource) noexcept : m_resource(resource) {};
+
+    /**
+     * 允许容器把分配器rebind到节点类型
+     * @tparam U
+     * @param that
+     */
+    template<class U>
+    PolymorphicAllocator(PolymorphicAllocator<U> const& that) noexcept : m_resource(that.m_resource) {};
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return static_cast<T *>(m_resource->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        m_resource->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    [[nodiscard]] MemoryResource* resource() const noexcept {
+        return m_resource;
+    }
+
+    template<class U>
+    bool operator==(PolymorphicAllocator<U> const& that) const noexcept {
+        return m_resource->is_equal(*that.m_resource);
+    }
+};
@@ -0,0 +1,117 @@
+#include <cassert>
+#include <string>
+#include <iostream>
+
+#include "memoryResource.hpp"
+#include "../vectors/vectors.hpp"
+#include "../vectors/smallVectors.hpp"
+#include "../sets/sets.hpp"
+
+/**
+ * 统计上游被调用的次数
+ */
+class CountingResource : public MemoryResource {
+public:
+    int allocations = 0;
+    int deallocations = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        allocations++;
+        return default_resource()->allocate(bytes, align);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t align) override {
+        deallocations++;
+        default_resource()->deallocate(p, bytes, align);
+    }
+};
+
+template <class T>
+using ScratchVectors = Vectors<T, PolymorphicAllocator<T>>;
+
+int main() {
+    CountingResource upstream;
+    {
+        /* 一次请求内的scratch向量都从arena中分配, 请求结束时一次性释放 */
+        MonotonicArena arena(4096, &upstream);
+        {
+            ScratchVectors<int> ids(&arena);
+            ScratchVectors<std::string> names{PolymorphicAllocator<std::string>(&arena)};
+            for (int i = 0; i < 1000; i++) {
+                ids.push_back(i);
+                names.emplace_back(std::to_string(i));
+            }
+            assert(ids[999] == 999 && names[999] == "999");
+            std::cout << "arena upstream allocations: " << upstream.allocations << std::endl;
+
+            /* 使用不同资源的向量类型相同, 可以互相赋值; 拷贝赋值不传播分配器, 元素仍然从原来的资源申请 */
+            ScratchVectors<int> heap_ids;
+            heap_ids = ids;
+            assert(heap_ids.get_allocator() != ids.get_allocator() && heap_ids.size() == 1000);
+            assert(heap_ids.get_allocator() == PolymorphicAllocator<int>() && heap_ids[999] == 999);
+
+            /* 移动赋值同样不传播分配器: 资源相同时接管内存, 不同时逐个move到自己的资源中 */
+            int const* buffer = ids.cbegin();
+            ScratchVectors<int> arena_ids(&arena);
+            arena_ids = std::move(ids);
+            assert(arena_ids.cbegin() == buffer && ids.size() == 0);
+            heap_ids = std::move(arena_ids);
+            assert(heap_ids.get_allocator() == PolymorphicAllocator<int>() && heap_ids.cbegin() != buffer);
+            assert(heap_ids.size() == 1000 && heap_ids[999] == 999);
+        }
+
+        int before = upstream.deallocations;
+        arena.release();
+        assert(upstream.deallocations > before);
+    }
+    assert(upstream.allocations == upstream.deallocations);
+    std::cout << "-----------------------------" << std::endl;
+
+    {
+        /* 相同大小的块被回收后再次使用, 不会再向上游申请 */
+        PoolResource pool(&upstream);
+        PolymorphicAllocator<double> alloc(&pool);
+        double* a = alloc.allocate(4);
+        alloc.deallocate(a, 4);
+        int before = upstream.allocations;
+        double* b = alloc.allocate(4);
+        assert(a == b && upstream.allocations == before);
+        alloc.deallocate(b, 4);
+
+        SmallVectors<long, 4, PolymorphicAllocator<long>> small(&pool);
+        for (long i = 0; i < 64; i++) {
+            small.push_back(i);
+        }
+        assert(!small.is_inline() && small.back() == 63);
+
+        /* SmallVectors的拷贝赋值和移动赋值也不传播分配器 */
+        SmallVectors<long, 4, PolymorphicAllocator<long>> other;
+        other = small;
+        assert(other.get_allocator() == PolymorphicAllocator<long>() && other.size() == 64);
+        long const* buffer = small.cbegin();
+        SmallVectors<long, 4, PolymorphicAllocator<long>> pooled(&pool);
+        pooled = std::move(small);
+        assert(pooled.cbegin() == buffer && small.size() == 0);
+        other = std::move(pooled);
+        assert(other.get_allocator() == PolymorphicAllocator<long>() && other.cbegin() != buffer);
+        assert(other.size() == 64 && other.back() == 63);
+        std::cout << "pool upstream allocations: " << upstream.allocations << std::endl;
+    }
+    assert(upstream.allocations == upstream.deallocations);
+    std::cout << "-----------------------------" << std::endl;
+
+    {
+        /* 栈上的缓冲区足够时完全不调用上游 */
+        alignas(std::max_align_t) std::byte buffer[1024];
+        MonotonicArena arena(buffer, sizeof(buffer), &upstream);
+        int before = upstream.allocations;
+        ScratchVectors<int> stack_ids(&arena);
+        stack_ids.reserve(64);
+        assert(upstream.allocations == before);
+    }
+
+    Sets<int, std::less<int>, PolymorphicAllocator<int>> set;
+    (void) set;
+    return 0;
+}
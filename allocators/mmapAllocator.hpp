@@ -0,0 +1,104 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * 面向大块内存的分配器: 不小于Threshold字节的请求直接用mmap申请整页,
+ * 扩容时通过mremap完成, 不需要先申请两倍的内存再拷贝
+ * 小块请求仍然转发给operator new
+ *
+ * 提供@code{Vectors}识别的两个扩展接口:
+ * 1. try_expand: mremap(flags = 0), 只在原地扩大, 元素地址不变
+ * 2. reallocate: mremap(MREMAP_MAYMOVE), 由内核修改页表完成搬迁, 峰值内存保持在1倍左右
+ * @tparam T
+ * @tparam Threshold 使用mmap的最小字节数
+ */
+template<class T, size_t Threshold = size_t(1) << 20>
+class MmapAllocator {
+public:
+    using value_type = T;
+
+    template<class U>
+    struct rebind {
+        using other = MmapAllocator<U, Threshold>;
+    };
+
+    MmapAllocator() noexcept = default;
+
+    template<class U>
+    MmapAllocator(MmapAllocator<U, Threshold> const&) noexcept {};
+
+    [[nodiscard]] T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (!S_is_large(bytes)) return static_cast<T *>(::operator new(bytes, std::align_val_t(alignof(T))));
+
+        void* p = mmap(nullptr, S_round_to_page(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) throw std::bad_alloc();
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        size_t bytes = n * sizeof(T);
+        if (!S_is_large(bytes)) {
+            ::operator delete(p, bytes, std::align_val_t(alignof(T)));
+            return;
+        }
+        munmap(p, S_round_to_page(bytes));
+    }
+
+    /**
+     * 只有原本就是mmap出来的块才能原地扩大; 新旧大小落在同一页内时什么都不用做
+     * @param p
+     * @param old_n
+     * @param new_n
+     * @return
+     */
+    bool try_expand(T* p, size_t old_n, size_t new_n) noexcept {
+        size_t old_bytes = old_n * sizeof(T), new_bytes = new_n * sizeof(T);
+        if (!S_is_large(old_bytes)) return false;
+        size_t old_len = S_round_to_page(old_bytes), new_len = S_round_to_page(new_bytes);
+        if (old_len == new_len) return true;
+#ifdef __linux__
+        return mremap(p, old_len, new_len, 0) != MAP_FAILED;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * 允许换地址的扩容, 失败时返回nullptr, 原来的块保持不变
+     * @param p
+     * @param old_n
+     * @param new_n
+     * @return
+     */
+    T* reallocate(T* p, size_t old_n, size_t new_n) noexcept {
+#ifdef __linux__
+        size_t old_bytes = old_n * sizeof(T), new_bytes = new_n * sizeof(T);
+        if (!S_is_large(old_bytes)) return nullptr;
+        void* q = mremap(p, S_round_to_page(old_bytes), S_round_to_page(new_bytes), MREMAP_MAYMOVE);
+        return q == MAP_FAILED ? nullptr : static_cast<T *>(q);
+#else
+        return nullptr;
+#endif
+    }
+
+    template<class U>
+    bool operator==(MmapAllocator<U, Threshold> const&) const noexcept {
+        return true;
+    }
+
+private:
+    static bool S_is_large(size_t bytes) noexcept {
+        return bytes >= Threshold;
+    }
+
+    static size_t S_round_to_page(size_t bytes) noexcept {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page - 1) / page * page;
+    }
+};
@@ -0,0 +1,60 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <iostream>
+#include <sys/resource.h>
+
+#include "mmapAllocator.hpp"
+#include "../vectors/vectors.hpp"
+
+/**
+ * 统计真正申请新内存块的次数, 扩容走mremap时不会经过allocate
+ */
+template <class T>
+struct CountingMmapAllocator : MmapAllocator<T> {
+    using value_type = T;
+    static inline int allocations = 0;
+
+    T* allocate(size_t n) {
+        allocations++;
+        return MmapAllocator<T>::allocate(n);
+    }
+};
+
+long peak_rss_mb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+}
+
+int main() {
+    constexpr size_t n = 32 * 1024 * 1024; // 256MB的uint64_t
+    {
+        Vectors<uint64_t, CountingMmapAllocator<uint64_t>> samples;
+        for (size_t i = 0; i < n; i++) {
+            samples.push_back(i);
+        }
+        for (size_t i = 0; i < n; i += 4096) {
+            assert(samples[i] == i);
+        }
+        std::cout << "mmap allocations: " << CountingMmapAllocator<uint64_t>::allocations
+                  << " capacity: " << samples.capacity() << std::endl;
+        /* 超过阈值(1MB)之后的扩容都由mremap完成 */
+        assert(CountingMmapAllocator<uint64_t>::allocations <= 18);
+
+        samples.insert(samples.begin() + 1, 42);
+        samples.reserve(samples.capacity() + 1);
+        assert(samples[1] == 42 && samples[2] == 1 && samples.back() == n - 1);
+    }
+    std::cout << "peak rss (mmap growth): " << peak_rss_mb() << " MB" << std::endl;
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 非trivially relocatable的类型只能使用try_expand, 失败时正常搬迁 */
+    Vectors<std::string, MmapAllocator<std::string, 4096>> names;
+    for (int i = 0; i < 10000; i++) {
+        names.push_back(std::to_string(i));
+    }
+    names.insert(names.begin(), names[9999]);
+    assert(names.size() == 10001 && names[0] == "9999" && names[10000] == "9999");
+    return 0;
+}
@@ -0,0 +1,451 @@
+#pragma once
+
+#include <bit>
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+#include "../vectors/vectors.hpp"
+
+/**
+ * 双端队列: 元素存放在固定大小的块中, 块指针存放在一个@code{Vectors<T*>}(map)里
+ * 1. 两端的push/pop都是O(1), 元素不会搬迁, 指向元素的引用和指针在元素被删除之前一直有效
+ *    (迭代器在push之后失效, 与std::deque相同)
+ * 2. 第i个元素在全局位置p = m_begin + i, 位于m_map[p / kBlockSize]的第p % kBlockSize个,
+ *    kBlockSize是2的幂, 下标访问只有移位/掩码和两次读内存
+ * 3. 空出来的块不还给分配器, 串成空闲链表留给下一次push使用, 稳定状态下的FIFO/LIFO不再分配内存;
+ *    空闲块由shrink_to_fit()释放
+ * 4. map的一端用完时, 如果另一端空着的槽位足够多就把使用中的块指针移回中间, 否则map扩大一倍
+ * @tparam T
+ * @tparam Alloc 用于分配块, map使用rebind到T*的同一个分配器
+ */
+template<class T, class Alloc = std::allocator<T>>
+class Deques {
+public:
+    /** 每块的元素个数: 大约4KB, 至少16个 */
+    static constexpr size_t kBlockSize = std::bit_floor(std::max<size_t>(4096 / sizeof(T), 16));
+
+private:
+    static constexpr int kShift = std::countr_zero(kBlockSize);
+    static constexpr size_t kMask = kBlockSize - 1;
+
+    using MapAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<T*>;
+    using Map = Vectors<T*, MapAlloc>;
+
+    [[no_unique_address]] Alloc allocator;
+
+    /** 使用中的块以外的槽位都是nullptr */
+    Map m_map;
+    /** 第一个元素的全局位置 */
+    size_t m_begin;
+    size_t m_size;
+    /** 空闲块链表, 下一个空闲块的地址存放在块的前sizeof(T*)个字节中 */
+    T* m_spare;
+
+    template<bool Const>
+    class Iterator {
+    private:
+        T* const* m_map;
+        size_t m_pos;
+
+        friend class Deques;
+        template<bool> friend class Iterator;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using difference_type = ptrdiff_t;
+        using value_type = T;
+        using pointer = std::conditional_t<Const, T const*, T*>;
+        using reference = std::conditional_t<Const, T const&, T&>;
+
+        Iterator() noexcept : m_map(nullptr), m_pos(0) {};
+        Iterator(T* const* map, size_t pos) noexcept : m_map(map), m_pos(pos) {};
+
+        /**
+         * iterator可以隐式转换为const_iterator
+         */
+        template<bool C = Const> requires C
+        Iterator(Iterator<false> const& that) noexcept : m_map(that.m_map), m_pos(that.m_pos) {};
+
+        reference operator*() const noexcept {
+            return m_map[m_pos >> kShift][m_pos & kMask];
+        }
+
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+
+        reference operator[](difference_type k) const noexcept {
+            return *(*this + k);
+        }
+
+        Iterator& operator++() noexcept {
+            ++m_pos;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator tmp = *this;
+            ++m_pos;
+            return tmp;
+        }
+
+        Iterator& operator--() noexcept {
+            --m_pos;
+            return *this;
+        }
+
+        Iterator operator--(int) noexcept {
+            Iterator tmp = *this;
+            --m_pos;
+            return tmp;
+        }
+
+        Iterator& operator+=(difference_type k) noexcept {
+            m_pos += k;
+            return *this;
+        }
+
+        Iterator& operator-=(difference_type k) noexcept {
+            m_pos -= k;
+            return *this;
+        }
+
+        Iterator operator+(difference_type k) const noexcept {
+            return Iterator(m_map, m_pos + k);
+        }
+
+        friend Iterator operator+(difference_type k, Iterator const& it) noexcept {
+            return it + k;
+        }
+
+        Iterator operator-(difference_type k) const noexcept {
+            return Iterator(m_map, m_pos - k);
+        }
+
+        difference_type operator-(Iterator const& that) const noexcept {
+            return static_cast<difference_type>(m_pos) - static_cast<difference_type>(that.m_pos);
+        }
+
+        bool operator==(Iterator const& that) const noexcept {
+            return m_pos == that.m_pos;
+        }
+
+        auto operator<=>(Iterator const& that) const noexcept {
+            return m_pos <=> that.m_pos;
+        }
+    };
+
+public:
+    using value_type = T;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    Deques() : m_map(MapAlloc(allocator)), m_begin(0), m_size(0), m_spare(nullptr) {};
+
+    explicit Deques(Alloc const& alloc) : allocator(alloc), m_map(MapAlloc(allocator)), m_begin(0), m_size(0), m_spare(nullptr) {};
+
+    Deques(std::initializer_list<T> list) : Deques() {
+        try {
+            for (auto const& val: list) {
+                push_back(val);
+            }
+        } catch (...) {
+            M_release();
+            throw;
+        }
+    }
+
+    Deques(Deques const& that)
+    : allocator(std::allocator_traits<Alloc>::select_on_container_copy_construction(that.allocator)),
+      m_map(MapAlloc(allocator)), m_begin(0), m_size(0), m_spare(nullptr) {
+        try {
+            for (size_t i = 0; i < that.m_size; i++) {
+                push_back(that[i]);
+            }
+        } catch (...) {
+            M_release();
+            throw;
+        }
+    }
+
+    Deques& operator=(Deques const& that) {
+        if (this == &that) return *this;
+        Deques tmp(that);
+        swap(tmp);
+        return *this;
+    }
+
+    Deques(Deques&& that) noexcept
+    : allocator(std::move(that.allocator)), m_map(std::move(that.m_map)),
+      m_begin(that.m_begin), m_size(that.m_size), m_spare(that.m_spare) {
+        that.m_begin = that.m_size = 0;
+        that.m_spare = nullptr;
+    }
+
+    Deques& operator=(Deques&& that) noexcept {
+        if (this == &that) return *this;
+        M_release();
+        allocator = that.allocator;
+        m_map = std::move(that.m_map);
+        m_begin = that.m_begin;
+        m_size = that.m_size;
+        m_spare = that.m_spare;
+        that.m_begin = that.m_size = 0;
+        that.m_spare = nullptr;
+        return *this;
+    }
+
+    ~Deques() {
+        M_release();
+    }
+
+    void swap(Deques& that) noexcept {
+        std::swap(allocator, that.allocator);
+        m_map.swap(that.m_map);
+        std::swap(m_begin, that.m_begin);
+        std::swap(m_size, that.m_size);
+        std::swap(m_spare, that.m_spare);
+    }
+
+    void push_back(T const& val) {
+        emplace_back(val);
+    }
+
+    void push_back(T&& val) {
+        emplace_back(std::move(val));
+    }
+
+    void push_front(T const& val) {
+        emplace_front(val);
+    }
+
+    void push_front(T&& val) {
+        emplace_front(std::move(val));
+    }
+
+    template<class ...Args>
+    T& emplace_back(Args &&... args) {
+        if (((m_begin + m_size) >> kShift) == m_map.size()) [[unlikely]] M_recenter();
+        size_t pos = m_begin + m_size;
+        T* p = M_construct(pos, std::forward<Args>(args)...);
+        m_size += 1;
+        return *p;
+    }
+
+    template<class ...Args>
+    T& emplace_front(Args &&... args) {
+        if (m_begin == 0) [[unlikely]] M_recenter();
+        size_t pos = m_begin - 1;
+        T* p = M_construct(pos, std::forward<Args>(args)...);
+        m_begin = pos;
+        m_size += 1;
+        return *p;
+    }
+
+    /**
+     * 最后一个元素所在的块空出来时放回空闲链表
+     */
+    void pop_back() {
+        m_size -= 1;
+        size_t pos = m_begin + m_size;
+        std::destroy_at(M_slot(pos));
+        if (m_size == 0 || (pos & kMask) == 0) M_recycle(pos >> kShift);
+        if (m_size == 0) M_reset_begin();
+    }
+
+    void pop_front() {
+        size_t pos = m_begin;
+        std::destroy_at(M_slot(pos));
+        m_begin += 1;
+        m_size -= 1;
+        if (m_size == 0 || (m_begin & kMask) == 0) M_recycle(pos >> kShift);
+        if (m_size == 0) M_reset_begin();
+    }
+
+    /**
+     * 析构所有元素, 块全部放回空闲链表
+     */
+    void clear() noexcept {
+        if (m_size == 0) return;
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = 0; i < m_size; i++) {
+                std::destroy_at(M_slot(m_begin + i));
+            }
+        }
+        size_t first = m_begin >> kShift, last = (m_begin + m_size - 1) >> kShift;
+        for (size_t k = first; k <= last; k++) {
+            M_recycle(k);
+        }
+        m_size = 0;
+        M_reset_begin();
+    }
+
+    /**
+     * 释放空闲链表中的块
+     */
+    void shrink_to_fit() noexcept {
+        while (m_spare != nullptr) {
+            allocator.deallocate(M_take_spare(), kBlockSize);
+        }
+    }
+
+    T const& operator[](size_t i) const noexcept {
+        return *M_slot(m_begin + i);
+    }
+
+    T& operator[](size_t i) noexcept {
+        return *M_slot(m_begin + i);
+    }
+
+    [[nodiscard]] T const& at(size_t i) const {
+        if (i >= m_size) throw std::out_of_range("deque::at");
+        return (*this)[i];
+    }
+
+    T& at(size_t i) {
+        if (i >= m_size) throw std::out_of_range("deque::at");
+        return (*this)[i];
+    }
+
+    [[nodiscard]] T const& front() const {
+        return at(0);
+    }
+
+    T& front() {
+        return at(0);
+    }
+
+    [[nodiscard]] T const& back() const {
+        return at(m_size - 1);
+    }
+
+    T& back() {
+        return at(m_size - 1);
+    }
+
+    iterator begin() noexcept {
+        return iterator(m_map.data(), m_begin);
+    }
+
+    iterator end() noexcept {
+        return iterator(m_map.data(), m_begin + m_size);
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator(m_map.data(), m_begin);
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator(m_map.data(), m_begin + m_size);
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    [[nodiscard]] const_iterator cend() const noexcept {
+        return end();
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_size;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    [[nodiscard]] Alloc get_allocator() const noexcept {
+        return allocator;
+    }
+
+private:
+    T* M_slot(size_t pos) const noexcept {
+        return m_map[pos >> kShift] + (pos & kMask);
+    }
+
+    T* M_take_spare() noexcept {
+        T* block = m_spare;
+        std::memcpy(&m_spare, static_cast<void const *>(block), sizeof(T*));
+        return block;
+    }
+
+    /**
+     * 把第k个槽位的块放回空闲链表, 不会失败
+     * @param k
+     */
+    void M_recycle(size_t k) noexcept {
+        T* block = m_map[k];
+        m_map[k] = nullptr;
+        std::memcpy(static_cast<void *>(block), &m_spare, sizeof(T*));
+        m_spare = block;
+    }
+
+    /**
+     * 在全局位置pos构造元素, 所在的块不存在时先从空闲链表或者分配器取一块
+     * 构造失败时新取的块放回空闲链表, 队列保持不变
+     */
+    template<class ...Args>
+    T* M_construct(size_t pos, Args &&... args) {
+        size_t k = pos >> kShift;
+        bool fresh = m_map[k] == nullptr;
+        if (fresh) m_map[k] = m_spare != nullptr ? M_take_spare() : allocator.allocate(kBlockSize);
+        T* p = m_map[k] + (pos & kMask);
+        try {
+            std::construct_at(p, std::forward<Args>(args)...);
+        } catch (...) {
+            if (fresh) M_recycle(k);
+            throw;
+        }
+        return p;
+    }
+
+    /**
+     * 队列为空时把起点放回map的中间, 两端都留出空间
+     */
+    void M_reset_begin() noexcept {
+        m_begin = (m_map.size() / 2) << kShift;
+    }
+
+    /**
+     * map的一端没有空槽位时调用: 把使用中的块指针移到map的中间
+     * 空槽位不到使用中块数的两倍时先把map扩大一倍; 之后两端都至少有一个空槽位
+     */
+    void M_recenter() {
+        size_t used = m_size == 0 ? 0 : ((m_begin + m_size - 1) >> kShift) - (m_begin >> kShift) + 1;
+        size_t first = m_begin >> kShift, slots = m_map.size();
+        if (slots < 2 * used + 2) {
+            Map map((MapAlloc(allocator)));
+            map.resize(std::max({slots * 2, 2 * used + 2, size_t(8)}), nullptr);
+            size_t target = (map.size() - used) / 2;
+            std::copy_n(m_map.data() + first, used, map.data() + target);
+            m_map.swap(map);
+            first = target;
+        } else {
+            size_t target = (slots - used) / 2;
+            T** data = m_map.data();
+            if (target < first) {
+                std::copy(data + first, data + first + used, data + target);
+                std::fill(data + std::max(target + used, first), data + first + used, nullptr);
+            } else {
+                std::copy_backward(data + first, data + first + used, data + target + used);
+                std::fill(data + first, data + std::min(first + used, target), nullptr);
+            }
+            first = target;
+        }
+        m_begin = m_size == 0 ? (m_map.size() / 2) << kShift : (first << kShift) | (m_begin & kMask);
+    }
+
+    void M_release() noexcept {
+        clear();
+        shrink_to_fit();
+    }
+};
@@ -0,0 +1,90 @@
+#include <deque>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <numeric>
+
+#include "deques.hpp"
+
+/**
+ * FIFO: 队列保持depth个元素, 每次push_back一个再pop_front一个, 模拟工作队列的稳定状态
+ */
+template<class Queue>
+double bench_fifo(size_t depth, size_t ops, long& sink) {
+    Queue q;
+    for (size_t i = 0; i < depth; i++) {
+        q.push_back(static_cast<long>(i));
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < ops; i++) {
+        q.push_back(static_cast<long>(i));
+        sink += q.front();
+        q.pop_front();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+/**
+ * LIFO: 反复压入burst个元素再全部弹出, 每一轮都会跨越多个块的边界
+ */
+template<class Queue>
+double bench_lifo(size_t burst, size_t ops, long& sink) {
+    Queue q;
+    size_t rounds = ops / burst;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < burst; i++) {
+            q.push_back(static_cast<long>(i));
+        }
+        for (size_t i = 0; i < burst; i++) {
+            sink += q.back();
+            q.pop_back();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / (rounds * burst * 2);
+}
+
+/**
+ * 两端交替push_front/push_back建立队列, 然后用迭代器遍历求和
+ */
+template<class Queue>
+double bench_scan(size_t n, long& sink) {
+    Queue q;
+    for (size_t i = 0; i < n; i++) {
+        if (i % 2 == 0) {
+            q.push_back(static_cast<long>(i));
+        } else {
+            q.push_front(static_cast<long>(i));
+        }
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    sink += std::accumulate(q.begin(), q.end(), 0L);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / n;
+}
+
+void report(char const* name, double ours, double theirs) {
+    std::cout << std::left << std::setw(24) << name
+              << "Deques: " << std::setw(10) << ours
+              << "std::deque: " << std::setw(10) << theirs
+              << "ns/op" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t ops = argc > 1 ? std::stoull(argv[1]) : 50000000;
+    long sink = 0;
+    for (size_t depth: {16, 1000, 100000}) {
+        std::string name = "fifo depth " + std::to_string(depth);
+        report(name.c_str(), bench_fifo<Deques<long>>(depth, ops, sink), bench_fifo<std::deque<long>>(depth, ops, sink));
+    }
+    for (size_t burst: {100, 10000, 1000000}) {
+        std::string name = "lifo burst " + std::to_string(burst);
+        report(name.c_str(), bench_lifo<Deques<long>>(burst, ops, sink), bench_lifo<std::deque<long>>(burst, ops, sink));
+    }
+    report("scan 10M", bench_scan<Deques<long>>(10000000, sink), bench_scan<std::deque<long>>(10000000, sink));
+    std::cout << "(checksum " << sink % 1000 << ")" << std::endl;
+    return 0;
+}
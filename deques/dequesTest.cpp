@@ -0,0 +1,143 @@
+#include <deque>
+#include <random>
+#include <string>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+
+#include "deques.hpp"
+
+/** 记录块的分配次数 */
+inline size_t g_allocations = 0;
+
+template<class T>
+struct CountingAllocator : std::allocator<T> {
+    template<class U>
+    struct rebind {
+        using other = CountingAllocator<U>;
+    };
+
+    CountingAllocator() noexcept = default;
+
+    template<class U>
+    CountingAllocator(CountingAllocator<U> const&) noexcept {};
+
+    T* allocate(size_t n) {
+        g_allocations += 1;
+        return std::allocator<T>::allocate(n);
+    }
+};
+
+static_assert(std::random_access_iterator<Deques<int>::iterator>);
+static_assert(std::random_access_iterator<Deques<int>::const_iterator>);
+
+int main() {
+    /* 两端插入删除, 下标访问与迭代器 */
+    {
+        Deques<int> dq = {3, 4, 5};
+        for (int i = 2; i >= 0; i--) {
+            dq.push_front(i);
+        }
+        dq.emplace_back(6);
+        assert(dq.size() == 7 && dq.front() == 0 && dq.back() == 6 && dq[3] == 3);
+        for (int x: dq) {
+            std::cout << x << " ";
+        }
+        std::cout << std::endl;
+        assert(std::is_sorted(dq.begin(), dq.end()));
+        Deques<int>::const_iterator it = dq.begin() + 2;
+        assert(*it == 2 && dq.cend() - it == 5 && it[1] == 3);
+        dq.pop_front();
+        dq.pop_back();
+        assert(dq.size() == 5 && dq.front() == 1 && dq.back() == 5);
+
+        bool thrown = false;
+        try {
+            dq.at(5);
+        } catch (std::out_of_range const&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 引用在两端增长时保持有效, 与std::deque的结果一致 */
+    {
+        Deques<std::string> dq;
+        std::deque<std::string> ref;
+        dq.push_back("anchor");
+        ref.push_back("anchor");
+        std::string& anchor = dq.front();
+        std::mt19937 rng(7);
+        for (int i = 0; i < 200000; i++) {
+            std::string s = std::to_string(i) + std::string(i % 40, 'x');
+            switch (rng() % 5) {
+                case 0:
+                    dq.push_front(s);
+                    ref.push_front(s);
+                    break;
+                case 1:
+                    dq.push_back(s);
+                    ref.push_back(s);
+                    break;
+                case 2:
+                    if (&dq.front() == &anchor) break;
+                    dq.pop_front();
+                    ref.pop_front();
+                    break;
+                case 3:
+                    if (&dq.back() == &anchor) break;
+                    dq.pop_back();
+                    ref.pop_back();
+                    break;
+                default:
+                    ref.push_front(s);
+                    dq.emplace_front(std::move(s));
+            }
+        }
+        assert(anchor == "anchor" && dq.size() == ref.size());
+        assert(std::equal(dq.begin(), dq.end(), ref.begin(), ref.end()));
+        std::cout << "size: " << dq.size() << ", anchor at " << std::find(dq.cbegin(), dq.cend(), "anchor") - dq.cbegin() << std::endl;
+
+        Deques<std::string> copy = dq;
+        assert(copy.size() == dq.size() && std::equal(copy.begin(), copy.end(), dq.begin()));
+        Deques<std::string> moved = std::move(copy);
+        assert(copy.empty() && moved.size() == dq.size());
+        moved.clear();
+        moved.push_back("again");
+        assert(moved.size() == 1 && moved[0] == "again");
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 稳定状态下的FIFO/LIFO不再分配块 */
+    {
+        Deques<int, CountingAllocator<int>> queue;
+        for (int i = 0; i < 10000; i++) {
+            queue.push_back(i);
+        }
+        size_t warm = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            // 第一轮让块和map达到稳定的数量, 第二轮不应该再分配
+            warm = g_allocations;
+            for (int i = 0; i < 1000000; i++) {
+                queue.push_back(i);
+                queue.pop_front();
+            }
+            for (int round = 0; round < 1000; round++) {
+                for (int i = 0; i < 3000; i++) {
+                    queue.push_back(i);
+                }
+                for (int i = 0; i < 3000; i++) {
+                    queue.pop_back();
+                }
+            }
+        }
+        std::cout << "allocations after warm up: " << g_allocations - warm << std::endl;
+        assert(queue.size() == 10000 && queue.front() == 990000 && g_allocations == warm);
+        queue.clear();
+        queue.shrink_to_fit();
+        assert(queue.empty());
+    }
+    std::cout << "-----------------------------" << std::endl;
+    return 0;
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <numeric>
+
+#include "threadPool.hpp"
+#include "../vectors/vectors.hpp"
+
+/**
+ * 基于@code{ThreadPool}的并行算法, 接受@code{Vectors<T>}或者它的T*区间
+ * grain是每个任务至少处理的元素个数, 传0时根据元素个数和线程数自动选择;
+ * 元素个数不超过grain时直接在当前线程串行执行
+ */
+
+namespace parallel_detail {
+
+inline size_t S_grain(size_t n, size_t grain, ThreadPool& pool) noexcept {
+    if (grain != 0) return grain;
+    // 每个线程大约分到8个任务, 方便负载均衡; 太小的任务调度开销大于收益
+    return std::max<size_t>(n / ((pool.size() + 1) * 8), 4096);
+}
+
+/**
+ * 把[begin, end)二分, 右半部分作为任务交给线程池(可以被其他线程偷走), 左半部分继续二分
+ */
+template<class F>
+void S_split(TaskGroup& group, size_t begin, size_t end, size_t grain, F const& body) {
+    while (end - begin > grain) {
+        size_t mid = begin + (end - begin) / 2;
+        group.run([&group, mid, end, grain, &body] { S_split(group, mid, end, grain, body); });
+        end = mid;
+    }
+    body(begin, end);
+}
+
+/**
+ * 对[0, n)的每个子区间调用body(begin, end), 返回时所有子区间都已完成
+ */
+template<class F>
+void S_for_range(size_t n, size_t grain, ThreadPool& pool, F const& body) {
+    grain = S_grain(n, grain, pool);
+    if (n <= grain) {
+        if (n != 0) body(0, n);
+        return;
+    }
+    TaskGroup group(pool);
+    S_split(group, 0, n, grain, body);
+    group.wait();
+}
+
+/**
+ * 两个有序区间并行归并到out(已构造的内存, 使用move赋值)
+ * 较长的区间取中点, 在另一个区间中二分找到分割点, 两边独立归并
+ */
+template<class T, class Compare>
+void S_merge(TaskGroup& group, T* a, T* a_end, T* b, T* b_end, T* out, Compare const& comp, size_t grain) {
+    while (static_cast<size_t>((a_end - a) + (b_end - b)) > grain) {
+        if (a_end - a < b_end - b) {
+            std::swap(a, b);
+            std::swap(a_end, b_end);
+        }
+        T* a_mid = a + (a_end - a) / 2;
+        T* b_mid = std::lower_bound(b, b_end, *a_mid, comp);
+        T* out_mid = out + (a_mid - a) + (b_mid - b);
+        group.run([&group, a_mid, a_end, b_mid, b_end, out_mid, &comp, grain] {
+            S_merge(group, a_mid, a_end, b_mid, b_end, out_mid, comp, grain);
+        });
+        a_end = a_mid;
+        b_end = b_mid;
+    }
+    std::merge(std::make_move_iterator(a), std::make_move_iterator(a_end),
+               std::make_move_iterator(b), std::make_move_iterator(b_end), out, comp);
+}
+
+/**
+ * 归并排序, src和buf长度相同
+ * to_buf为false时结果留在src中, 否则留在buf中; 两个子区间的结果放在另一侧, 归并回来
+ */
+template<class T, class Compare>
+void S_sort(T* src, T* buf, size_t n, bool to_buf, Compare const& comp, size_t grain, ThreadPool& pool) {
+    if (n <= grain) {
+        std::sort(src, src + n, comp);
+        if (to_buf) std::move(src, src + n, buf);
+        return;
+    }
+    size_t half = n / 2;
+    {
+        TaskGroup group(pool);
+        group.run([=, &comp, &pool] { S_sort(src, buf, half, !to_buf, comp, grain, pool); });
+        S_sort(src + half, buf + half, n - half, !to_buf, comp, grain, pool);
+        group.wait();
+    }
+    T* from = to_buf ? src : buf;
+    T* to = to_buf ? buf : src;
+    TaskGroup group(pool);
+    S_merge(group, from, from + half, from + half, from + n, to, comp, grain);
+    group.wait();
+}
+
+} // namespace parallel_detail
+
+/**
+ * 对每个元素调用f(T&)
+ */
+template<class T, class F>
+void parallel_for_each(T* first, T* last, F f, size_t grain = 0, ThreadPool& pool = ThreadPool::instance()) {
+    parallel_detail::S_for_range(last - first, grain, pool, [first, &f](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            f(first[i]);
+        }
+    });
+}
+
+template<class T, class Alloc, class Growth, class F>
+void parallel_for_each(Vectors<T, Alloc, Growth>& vec, F f, size_t grain = 0, ThreadPool& pool = ThreadPool::instance()) {
+    parallel_for_each(vec.begin(), vec.end(), std::move(f), grain, pool);
+}
+
+/**
+ * out[i] = f(first[i]), out必须已经有足够的元素, 可以与输入相同
+ */
+template<class T, class U, class F>
+void parallel_transform(T const* first, T const* last, U* out, F f, size_t grain = 0,
+                        ThreadPool& pool = ThreadPool::instance()) {
+    parallel_detail::S_for_range(last - first, grain, pool, [first, out, &f](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            out[i] = f(first[i]);
+        }
+    });
+}
+
+/**
+ * out会被resize到与in相同的大小, 新增的元素马上会被覆盖, 因此只做默认初始化
+ */
+template<class T, class AllocT, class GrowthT, class U, class AllocU, class GrowthU, class F>
+void parallel_transform(Vectors<T, AllocT, GrowthT> const& in, Vectors<U, AllocU, GrowthU>& out, F f, size_t grain = 0,
+                        ThreadPool& pool = ThreadPool::instance()) {
+    out.resize_for_overwrite(in.size());
+    parallel_transform(in.cbegin(), in.cend(), out.begin(), std::move(f), grain, pool);
+}
+
+/**
+ * op必须满足结合律; 各个块的结果按顺序合并, 因此不要求交换律
+ */
+template<class T, class R, class Op = std::plus<>>
+R parallel_reduce(T const* first, T const* last, R init, Op op = {}, size_t grain = 0,
+                  ThreadPool& pool = ThreadPool::instance()) {
+    size_t n = last - first;
+    grain = parallel_detail::S_grain(n, grain, pool);
+    if (n <= grain) return std::accumulate(first, last, init, op);
+
+    size_t chunks = (n + grain - 1) / grain;
+    Vectors<R> partials(chunks, init);
+    parallel_detail::S_for_range(chunks, 1, pool, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            T const* p = first + c * grain;
+            T const* q = std::min(p + grain, last);
+            R acc = *p++;
+            for (; p != q; ++p) acc = op(std::move(acc), *p);
+            partials[c] = std::move(acc);
+        }
+    });
+    R res = std::move(init);
+    for (size_t c = 0; c < chunks; c++) {
+        res = op(std::move(res), std::move(partials[c]));
+    }
+    return res;
+}
+
+template<class T, class Alloc, class Growth, class R, class Op = std::plus<>>
+R parallel_reduce(Vectors<T, Alloc, Growth> const& vec, R init, Op op = {}, size_t grain = 0,
+                  ThreadPool& pool = ThreadPool::instance()) {
+    return parallel_reduce(vec.cbegin(), vec.cend(), std::move(init), std::move(op), grain, pool);
+}
+
+/**
+ * 并行归并排序(不稳定), 需要一块与输入等长的辅助内存, T需要可以默认构造
+ */
+template<class T, class Compare = std::less<>>
+void parallel_sort(T* first, T* last, Compare comp = {}, size_t grain = 0, ThreadPool& pool = ThreadPool::instance()) {
+    size_t n = last - first;
+    grain = parallel_detail::S_grain(n, grain, pool);
+    if (n <= grain) {
+        std::sort(first, last, comp);
+        return;
+    }
+    Vectors<T> buf(n);
+    parallel_detail::S_sort(first, buf.begin(), n, false, comp, grain, pool);
+}
+
+template<class T, class Alloc, class Growth, class Compare = std::less<>>
+void parallel_sort(Vectors<T, Alloc, Growth>& vec, Compare comp = {}, size_t grain = 0, ThreadPool& pool = ThreadPool::instance()) {
+    parallel_sort(vec.begin(), vec.end(), std::move(comp), grain, pool);
+}
+
+/**
+ * 包含式前缀和: out[i] = first[0] op ... op first[i], out可以与输入相同
+ * 两遍扫描: 先并行求每块的和, 串行求块之间的前缀, 再并行地在每块内扫描
+ */
+template<class T, class Op = std::plus<>>
+void parallel_scan(T const* first, T const* last, T* out, Op op = {}, size_t grain = 0,
+                   ThreadPool& pool = ThreadPool::instance()) {
+    size_t n = last - first;
+    grain = parallel_detail::S_grain(n, grain, pool);
+    if (n <= grain) {
+        std::inclusive_scan(first, last, out, op);
+        return;
+    }
+
+    size_t chunks = (n + grain - 1) / grain;
+    Vectors<T> sums(chunks);
+    parallel_detail::S_for_range(chunks, 1, pool, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            T const* p = first + c * grain;
+            T const* q = std::min(p + grain, last);
+            T acc = *p++;
+            for (; p != q; ++p) acc = op(std::move(acc), *p);
+            sums[c] = std::move(acc);
+        }
+    });
+    std::inclusive_scan(sums.begin(), sums.end(), sums.begin(), op);
+    parallel_detail::S_for_range(chunks, 1, pool, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; c++) {
+            size_t lo = c * grain, hi = std::min(lo + grain, n);
+            if (c == 0) {
+                std::inclusive_scan(first + lo, first + hi, out + lo, op);
+            } else {
+                std::inclusive_scan(first + lo, first + hi, out + lo, op, sums[c - 1]);
+            }
+        }
+    });
+}
+
+template<class T, class Alloc, class Growth, class Op = std::plus<>>
+void parallel_scan(Vectors<T, Alloc, Growth>& vec, Op op = {}, size_t grain = 0, ThreadPool& pool = ThreadPool::instance()) {
+    parallel_scan(vec.cbegin(), vec.cend(), vec.begin(), std::move(op), grain, pool);
+}
@@ -0,0 +1,77 @@
+#include <cassert>
+#include <chrono>
+#include <random>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+
+#include "parallel.hpp"
+
+int main() {
+    ThreadPool pool(4);
+    constexpr size_t n = 1000003;
+
+    Vectors<int64_t> vec(n);
+    for (size_t i = 0; i < n; i++) {
+        vec[i] = static_cast<int64_t>(i);
+    }
+
+    /* grain故意取得很小, 让任务数量远多于线程数, 覆盖偷任务的路径 */
+    parallel_for_each(vec, [](int64_t& v) { v *= 2; }, 1000, pool);
+    assert(vec[n - 1] == static_cast<int64_t>(2 * (n - 1)));
+
+    Vectors<double> halves;
+    parallel_transform(vec, halves, [](int64_t v) { return v / 2.0; }, 1000, pool);
+    assert(halves.size() == n && halves[12345] == 12345.0);
+
+    int64_t total = parallel_reduce(vec, int64_t(0), std::plus<>(), 1000, pool);
+    assert(total == static_cast<int64_t>(n) * static_cast<int64_t>(n - 1));
+    std::cout << "reduce: " << total << std::endl;
+
+    parallel_scan(vec, std::plus<>(), 1000, pool);
+    assert(vec[0] == 0 && vec[3] == 12 && vec[n - 1] == total);
+    std::cout << "scan back: " << vec[n - 1] << std::endl;
+    std::cout << "-----------------------------" << std::endl;
+
+    std::mt19937_64 rng(42);
+    Vectors<uint64_t> keys(n);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = rng();
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    parallel_sort(keys, std::less<>(), 0, pool);
+    auto end = std::chrono::high_resolution_clock::now();
+    for (size_t i = 1; i < n; i++) {
+        assert(keys[i - 1] <= keys[i]);
+    }
+    std::cout << "parallel_sort " << n << " keys: "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+    Vectors<std::string> words;
+    for (int i = 0; i < 20000; i++) {
+        words.push_back(std::to_string(rng() % 100000));
+    }
+    parallel_sort(words, std::greater<>(), 500, pool);
+    for (size_t i = 1; i < words.size(); i++) {
+        assert(words[i - 1] >= words[i]);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 任务中抛出的异常在等待的线程中重新抛出 */
+    bool caught = false;
+    try {
+        parallel_for_each(vec, [](int64_t& v) {
+            if (v == 12) throw std::runtime_error("boom");
+        }, 1000, pool);
+    } catch (std::runtime_error const& e) {
+        caught = true;
+    }
+    assert(caught);
+
+    /* 小区间直接串行执行 */
+    Vectors<int> small{3, 1, 2};
+    parallel_sort(small);
+    assert(small[0] == 1 && small[2] == 3);
+    std::cout << "default pool threads: " << ThreadPool::instance().size() << std::endl;
+    return 0;
+}
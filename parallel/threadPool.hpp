@@ -0,0 +1,217 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <random>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+#include "../vectors/vectors.hpp"
+
+/**
+ * work-stealing线程池
+ * 每个工作线程有自己的双端队列: 自己从尾部取(LIFO, 局部性好), 其他线程从头部偷(FIFO, 偷到的任务更大)
+ * 非工作线程提交的任务放在一个额外的公共队列中
+ * 等待任务组的线程不会阻塞, 而是帮忙执行队列中的任务, 因此任务中可以嵌套地fork/join
+ */
+class ThreadPool {
+private:
+    using Task = std::function<void()>;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /** m_queues[0, n)属于工作线程, m_queues[n]是公共队列 */
+    Vectors<std::thread> m_workers;
+    std::unique_ptr<WorkQueue[]> m_queues;
+    size_t m_num_queues;
+
+    std::atomic<size_t> m_queued;
+    std::atomic<bool> m_stop;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_cv;
+
+    /** 当前线程在哪个线程池中的第几个工作线程 */
+    static inline thread_local ThreadPool* t_pool = nullptr;
+    static inline thread_local size_t t_index = 0;
+
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+    : m_queues(new WorkQueue[threads + 1]), m_num_queues(threads + 1), m_queued(0), m_stop(false) {
+        m_workers.reserve(threads);
+        for (size_t i = 0; i < threads; i++) {
+            m_workers.emplace_back([this, i] { M_worker_loop(i); });
+        }
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+            m_stop.store(true);
+        }
+        m_sleep_cv.notify_all();
+        for (auto& worker: m_workers) {
+            worker.join();
+        }
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_workers.size();
+    }
+
+    /**
+     * 工作线程提交到自己的队列尾部, 其他线程提交到公共队列
+     * @param task
+     */
+    void submit(Task task) {
+        WorkQueue& queue = t_pool == this ? m_queues[t_index] : m_queues[m_num_queues - 1];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+        m_queued.fetch_add(1, std::memory_order_release);
+        {
+            // 与M_worker_loop中检查m_queued的过程互斥, 避免唤醒丢失
+            std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        }
+        m_sleep_cv.notify_one();
+    }
+
+    /**
+     * 取出并执行一个任务, 没有任务时返回false
+     * 供等待中的线程调用, 等待的同时推进其他任务
+     * @return
+     */
+    bool try_run_one() {
+        Task task;
+        if (!M_pop(task)) return false;
+        task();
+        return true;
+    }
+
+    /**
+     * 全局默认线程池, 线程数等于硬件并发数
+     * @return
+     */
+    static ThreadPool& instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    /**
+     * 依次尝试: 自己队列的尾部 -> 其他队列的头部(从随机位置开始) -> 公共队列
+     * @param task
+     * @return
+     */
+    bool M_pop(Task& task) {
+        size_t self = t_pool == this ? t_index : m_num_queues - 1;
+        {
+            WorkQueue& own = m_queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        if (m_queued.load(std::memory_order_acquire) == 0) return false;
+
+        thread_local std::minstd_rand rng(std::random_device{}());
+        size_t start = rng() % m_num_queues;
+        for (size_t k = 0; k < m_num_queues; k++) {
+            size_t victim = (start + k) % m_num_queues;
+            if (victim == self) continue;
+            WorkQueue& queue = m_queues[victim];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty()) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void M_worker_loop(size_t index) {
+        t_pool = this;
+        t_index = index;
+        while (true) {
+            if (try_run_one()) continue;
+
+            std::unique_lock<std::mutex> lock(m_sleep_mutex);
+            m_sleep_cv.wait(lock, [this] {
+                return m_stop.load() || m_queued.load(std::memory_order_acquire) != 0;
+            });
+            if (m_stop.load() && m_queued.load() == 0) return;
+        }
+    }
+};
+
+/**
+ * 一组可以等待的任务, 任务内部可以继续向同一个组提交任务
+ * 第一个抛出的异常会在wait()中重新抛出
+ */
+class TaskGroup {
+private:
+    ThreadPool& m_pool;
+    std::atomic<size_t> m_pending;
+    std::atomic<bool> m_failed;
+    std::exception_ptr m_exception;
+
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::instance()) noexcept
+    : m_pool(pool), m_pending(0), m_failed(false) {};
+
+    TaskGroup(TaskGroup const&) = delete;
+    TaskGroup& operator=(TaskGroup const&) = delete;
+
+    ~TaskGroup() {
+        // 保证任务中引用的局部变量在任务结束前不会被销毁
+        while (m_pending.load(std::memory_order_acquire) != 0) {
+            if (!m_pool.try_run_one()) std::this_thread::yield();
+        }
+    }
+
+    template<class F>
+    void run(F&& f) {
+        m_pending.fetch_add(1, std::memory_order_relaxed);
+        m_pool.submit([this, f = std::forward<F>(f)]() mutable {
+            if (!m_failed.load(std::memory_order_relaxed)) {
+                try {
+                    f();
+                } catch (...) {
+                    if (!m_failed.exchange(true)) m_exception = std::current_exception();
+                }
+            }
+            m_pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    /**
+     * 等待所有任务完成, 等待期间执行池中的任务
+     */
+    void wait() {
+        while (m_pending.load(std::memory_order_acquire) != 0) {
+            if (!m_pool.try_run_one()) std::this_thread::yield();
+        }
+        if (m_failed.load()) {
+            m_failed.store(false);
+            std::rethrow_exception(std::exchange(m_exception, nullptr));
+        }
+    }
+
+    [[nodiscard]] ThreadPool& pool() const noexcept {
+        return m_pool;
+    }
+};
@@ -0,0 +1,428 @@
+#pragma once
+
+#include <bit>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
+
+#include "sets.hpp"
+#include "../vectors/vectors.hpp"
+#include "../vectors/kernels.hpp"
+
+/**
+ * 元素按Compare严格递增存放在连续容器中的集合, 接口与@code{Sets}一致, 适合读多写少的场景
+ * 1. 查找是无分支的二分, 区间缩小到kScan个元素后一次数出其中小于key的个数;
+ *    算术类型使用默认比较器时这一步走kernels::count_less的SIMD实现
+ * 2. build_index()额外保存一份Eytzinger(BFS)顺序的副本, 之后contains/count走它,
+ *    搜索路径集中在数组前部并且可以提前预取; 任何修改都会丢弃这份索引
+ * 3. insert(first, last)先把新元素排序去重, 再与原有元素一次归并
+ * 4. 与@code{Sets}之间的转换都是O(n)
+ * 单个元素的插入删除需要移动后面的元素, 是O(n)
+ * @tparam T
+ * @tparam Compare
+ * @tparam Container 连续存储的容器, 需要默认构造和(n, val)构造, data(), size(), operator[], begin()/end(),
+ *         reserve(), push_back(), insert(), erase()和clear()
+ */
+template<class T, class Compare = std::less<>, class Container = Vectors<T>>
+class FlatSets {
+private:
+    Container m_data;
+    [[no_unique_address]] Compare m_comp;
+    Container m_index; // 下标从1开始的Eytzinger顺序, 为空表示没有索引
+
+    /* 算术类型与默认比较器的组合可以直接用SIMD比较 */
+    static constexpr bool kSimdScan = kernels::Arithmetic<T>
+        && (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<T>>);
+    static constexpr size_t kScan = kSimdScan ? 128 / sizeof(T) : 8;
+
+public:
+    using value_type = T;
+    using key_compare = Compare;
+    using container_type = Container;
+    using iterator = T const*;
+    using const_iterator = T const*;
+    using reverse_iterator = std::reverse_iterator<T const*>;
+    using const_reverse_iterator = std::reverse_iterator<T const*>;
+
+    FlatSets() = default;
+
+    explicit FlatSets(Compare const& comp) : m_data(), m_comp(comp), m_index() {};
+
+    template<std::input_iterator InputIt>
+    FlatSets(InputIt first, InputIt last, Compare const& comp = Compare()) : m_data(), m_comp(comp), m_index() {
+        insert(first, last);
+    }
+
+    /**
+     * 调用者保证输入严格递增, 直接复制
+     */
+    template<std::input_iterator InputIt>
+    FlatSets(sorted_unique_t, InputIt first, InputIt last, Compare const& comp = Compare())
+        : m_data(), m_comp(comp), m_index() {
+        for (; first != last; ++first) {
+            m_data.push_back(*first);
+        }
+    }
+
+    /**
+     * 接管一个已经严格递增的容器, 不复制元素
+     */
+    FlatSets(sorted_unique_t, Container data, Compare const& comp = Compare())
+        : m_data(std::move(data)), m_comp(comp), m_index() {};
+
+    FlatSets(std::initializer_list<T> list, Compare const& comp = Compare())
+        : FlatSets(list.begin(), list.end(), comp) {};
+
+    /**
+     * Sets的中序遍历已经有序, 按顺序追加即可
+     * @param set
+     */
+    template<class Alloc>
+    explicit FlatSets(Sets<T, Compare, Alloc> const& set) : m_data(), m_comp(set.key_comp()), m_index() {
+        m_data.reserve(set.size());
+        for (T const& val: set) {
+            m_data.push_back(val);
+        }
+    }
+
+    /**
+     * 转换为Sets, 用有序输入O(n)建树
+     * @return
+     */
+    template<class Alloc = std::allocator<T>>
+    [[nodiscard]] Sets<T, Compare, Alloc> to_sets(Alloc const& alloc = Alloc()) const {
+        return Sets<T, Compare, Alloc>(sorted_unique, begin(), end(), m_comp, alloc);
+    }
+
+    /**
+     * 取出底层容器, 之后集合为空
+     * @return
+     */
+    Container extract() && {
+        M_drop_index();
+        Container res(std::move(m_data));
+        m_data = Container();
+        return res;
+    }
+
+    std::pair<iterator, bool> insert(T const& val) {
+        return M_insert(val);
+    }
+
+    std::pair<iterator, bool> insert(T&& val) {
+        return M_insert(std::move(val));
+    }
+
+    template<class ...Args>
+    std::pair<iterator, bool> emplace(Args &&... args) {
+        return M_insert(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * 新元素先在临时容器中排序去重, 再与原有元素一次归并; 新元素都大于已有元素时直接追加
+     * 与已有元素相等的新元素被丢弃
+     * 输入可以引用本集合的元素, 例如@code{set.insert(set.begin(), set.end())}
+     * 抛出异常时集合保持不变
+     * @param first
+     * @param last
+     */
+    template<std::input_iterator InputIt>
+    void insert(InputIt first, InputIt last) {
+        Container staged;
+        for (; first != last; ++first) {
+            staged.push_back(*first);
+        }
+        if (staged.size() == 0) return;
+        T* p = staged.data();
+        T* p_end = p + staged.size();
+        std::sort(p, p_end, m_comp);
+        p_end = std::unique(p, p_end, [&](T const& a, T const& b) { return !m_comp(a, b); });
+        staged.erase(staged.begin() + (p_end - p), staged.end());
+
+        M_drop_index();
+        size_t old_size = m_data.size();
+        if (old_size != 0 && !m_comp(m_data[old_size - 1], staged[0])) {
+            M_merge(staged);
+            return;
+        }
+        try {
+            for (size_t i = 0; i < staged.size(); i++) {
+                m_data.push_back(std::move(staged[i]));
+            }
+        } catch (...) {
+            m_data.erase(m_data.begin() + old_size, m_data.end());
+            throw;
+        }
+    }
+
+    template<std::input_iterator InputIt>
+    void insert(sorted_unique_t, InputIt first, InputIt last) {
+        if (empty()) {
+            M_drop_index();
+            for (; first != last; ++first) {
+                m_data.push_back(*first);
+            }
+            return;
+        }
+        insert(first, last);
+    }
+
+    void insert(std::initializer_list<T> list) {
+        insert(list.begin(), list.end());
+    }
+
+    iterator erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        M_drop_index();
+        size_t i = first - data();
+        m_data.erase(m_data.begin() + i, m_data.begin() + (last - data()));
+        return data() + i;
+    }
+
+    size_t erase(T const& val) {
+        iterator it = find(val);
+        if (it == end()) return 0;
+        erase(it);
+        return 1;
+    }
+
+    void clear() {
+        M_drop_index();
+        m_data.clear();
+    }
+
+    void reserve(size_t n) {
+        m_data.reserve(n);
+    }
+
+    /**
+     * 建立Eytzinger顺序的查找索引, 占用与元素本身相同的内存; 修改集合后需要重新建立
+     */
+    void build_index() {
+        M_drop_index();
+        size_t n = m_data.size();
+        if (n == 0) return;
+        Container index(n + 1, m_data[0]);
+        size_t i = 0;
+        S_fill_index(m_data.data(), index.data(), n, 1, i);
+        m_index = std::move(index);
+    }
+
+    [[nodiscard]] bool has_index() const noexcept {
+        return m_index.size() != 0;
+    }
+
+    iterator find(T const& val) const {
+        return M_find(val);
+    }
+
+    template<class K> requires TransparentCompare<Compare>
+    iterator find(K const& key) const {
+        return M_find(key);
+    }
+
+    [[nodiscard]] bool contains(T const& val) const {
+        return M_contains(val);
+    }
+
+    template<class K> requires TransparentCompare<Compare>
+    [[nodiscard]] bool contains(K const& key) const {
+        return M_contains(key);
+    }
+
+    [[nodiscard]] size_t count(T const& val) const {
+        return M_contains(val) ? 1 : 0;
+    }
+
+    template<class K> requires TransparentCompare<Compare>
+    [[nodiscard]] size_t count(K const& key) const {
+        return M_contains(key) ? 1 : 0;
+    }
+
+    iterator lower_bound(T const& val) const {
+        return data() + M_lower_bound(val);
+    }
+
+    template<class K> requires TransparentCompare<Compare>
+    iterator lower_bound(K const& key) const {
+        return data() + M_lower_bound(key);
+    }
+
+    iterator upper_bound(T const& val) const {
+        return M_upper_bound(val);
+    }
+
+    template<class K> requires TransparentCompare<Compare>
+    iterator upper_bound(K const& key) const {
+        return M_upper_bound(key);
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_data.size();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return m_data.size() == 0;
+    }
+
+    [[nodiscard]] Compare key_comp() const {
+        return m_comp;
+    }
+
+    [[nodiscard]] T const* data() const noexcept {
+        return m_data.data();
+    }
+
+    iterator begin() const noexcept {
+        return data();
+    }
+
+    iterator end() const noexcept {
+        return data() + m_data.size();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() const noexcept {
+        return reverse_iterator(end());
+    }
+
+    reverse_iterator rend() const noexcept {
+        return reverse_iterator(begin());
+    }
+
+private:
+    void M_drop_index() noexcept {
+        if (m_index.size() != 0) m_index = Container();
+    }
+
+    template<class V>
+    std::pair<iterator, bool> M_insert(V&& val) {
+        size_t i = M_lower_bound(val);
+        if (i != m_data.size() && !m_comp(val, m_data[i])) return {data() + i, false};
+        M_drop_index();
+        m_data.insert(m_data.begin() + i, std::forward<V>(val));
+        return {data() + i, true};
+    }
+
+    /**
+     * m_data与staged各自有序且无重复, 归并到新的容器中, 相等时保留前者
+     * 原有元素只在move不抛出异常时移动, 否则拷贝, 中途失败时m_data不受影响
+     */
+    void M_merge(Container& staged) {
+        Container merged;
+        merged.reserve(m_data.size() + staged.size());
+        T* a = m_data.data();
+        T* a_end = a + m_data.size();
+        T* b = staged.data();
+        T* b_end = b + staged.size();
+        while (a != a_end && b != b_end) {
+            if (m_comp(*b, *a)) {
+                merged.push_back(std::move(*b++));
+            } else {
+                if (!m_comp(*a, *b)) b++;
+                merged.push_back(std::move_if_noexcept(*a++));
+            }
+        }
+        for (; a != a_end; a++) {
+            merged.push_back(std::move_if_noexcept(*a));
+        }
+        for (; b != b_end; b++) {
+            merged.push_back(std::move(*b));
+        }
+        m_data = std::move(merged);
+    }
+
+    /**
+     * 第一个不小于key的下标
+     * 每一步用条件传送缩小区间, 剩下kScan个元素时整段比较, 统计小于key的个数
+     */
+    template<class K>
+    [[nodiscard]] size_t M_lower_bound(K const& key) const {
+        T const* first = m_data.data();
+        size_t n = m_data.size();
+        if (n <= kScan) return M_count_less(first, n, key);
+        // 不变式: base之前的元素都小于key, 结果在[base, base + len]中
+        T const* base = first;
+        size_t len = n;
+        while (len > kScan) {
+            size_t half = len / 2;
+            base += m_comp(base[half - 1], key) ? half : 0;
+            len -= half;
+        }
+        // 窗口固定为kScan个元素; 向前扩展的部分都小于key, 向后扩展的部分都不小于key, 不影响结果
+        T const* window = std::min(base, first + n - kScan);
+        return (window - first) + M_count_less(window, kScan, key);
+    }
+
+    template<class K>
+    [[nodiscard]] size_t M_count_less(T const* p, size_t n, K const& key) const {
+        if constexpr (kSimdScan && std::is_same_v<K, T>) {
+            return kernels::count_less(p, n, key);
+        } else {
+            size_t count = 0;
+            for (size_t i = 0; i < n; i++) {
+                count += m_comp(p[i], key);
+            }
+            return count;
+        }
+    }
+
+    template<class K>
+    [[nodiscard]] iterator M_upper_bound(K const& key) const {
+        iterator it = data() + M_lower_bound(key);
+        if (it != end() && !m_comp(key, *it)) it++;
+        return it;
+    }
+
+    template<class K>
+    [[nodiscard]] iterator M_find(K const& key) const {
+        iterator it = data() + M_lower_bound(key);
+        if (it != end() && !m_comp(key, *it)) return it;
+        return end();
+    }
+
+    template<class K>
+    [[nodiscard]] bool M_contains(K const& key) const {
+        if (m_index.size() == 0) return M_find(key) != end();
+        // 在Eytzinger数组中下降, 左子节点2k, 右子节点2k + 1
+        // k往下d层的2^d个后代从下标k * 2^d开始连续存放, 取2^d = 64 / sizeof(T)时正好占一个缓存行,
+        // 每一步预取它, d层之后不论走到哪个后代都已经在缓存中: int是4层, 8字节的类型是3层
+        T const* index = m_index.data();
+        size_t n = m_index.size() - 1, k = 1;
+        constexpr size_t kFanout = std::max<size_t>(64 / sizeof(T), 1);
+        while (k <= n) {
+#if defined(__GNUC__)
+            __builtin_prefetch(index + std::min(k * kFanout, n));
+#endif
+            k = 2 * k + m_comp(index[k], key);
+        }
+        // 最后一次向左走的位置就是lower_bound
+        k >>= std::countr_one(k) + 1;
+        return k != 0 && !m_comp(key, index[k]);
+    }
+
+    /**
+     * 按中序把有序数组填入完全二叉树的BFS顺序
+     */
+    static void S_fill_index(T const* sorted, T* index, size_t n, size_t k, size_t& i) {
+        if (k > n) return;
+        S_fill_index(sorted, index, n, 2 * k, i);
+        index[k] = sorted[i++];
+        S_fill_index(sorted, index, n, 2 * k + 1, i);
+    }
+};
@@ -0,0 +1,217 @@
+#include <set>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <string_view>
+
+#include "flatSets.hpp"
+
+template<class Set>
+void printSet(Set const& set, std::string const& name) {
+    std::cout << name << ": ";
+    for (auto const& x: set) {
+        std::cout << x << " ";
+    }
+    std::cout << std::endl;
+}
+
+/** armed时与-1比较抛出异常, 用于检查批量插入失败后集合不变 */
+struct ThrowingLess {
+    static inline bool armed = false;
+
+    bool operator()(int a, int b) const {
+        if (armed && (a == -1 || b == -1)) throw std::runtime_error("compare");
+        return a < b;
+    }
+};
+
+template<class F>
+long long timeMs(F f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+}
+
+static_assert(std::contiguous_iterator<FlatSets<int>::iterator>);
+
+int main() {
+    /* 基本接口 */
+    {
+        FlatSets<int> set = {5, 3, 8, 1, 4, 3};
+        printSet(set, "set");
+        assert(set.size() == 5 && std::is_sorted(set.begin(), set.end()));
+        auto [it, inserted] = set.insert(4);
+        assert(!inserted && *it == 4);
+        assert(set.insert(7).second && set.size() == 6 && *set.find(7) == 7);
+        assert(set.emplace(0).second && *set.begin() == 0);
+        assert(set.contains(8) && !set.contains(6) && set.count(1) == 1 && set.count(2) == 0);
+        assert(*set.lower_bound(6) == 7 && *set.upper_bound(7) == 8 && set.upper_bound(8) == set.end());
+        assert(set.find(100) == set.end() && set.lower_bound(-1) == set.begin());
+        assert(*set.rbegin() == 8);
+
+        assert(set.erase(3) == 1 && set.erase(3) == 0);
+        it = set.erase(set.find(4));
+        assert(*it == 5);
+        set.erase(set.begin(), set.find(7));
+        printSet(set, "after erase");
+        assert(set.size() == 2 && *set.begin() == 7);
+        set.clear();
+        assert(set.empty() && set.begin() == set.end());
+
+        FlatSets<int, std::greater<>> desc = {1, 3, 2};
+        assert(*desc.begin() == 3 && desc.contains(2) && *desc.lower_bound(2) == 2);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 随机操作与std::set比较, 覆盖SIMD扫描窗口的各个边界 */
+    {
+        std::mt19937 rng(1);
+        for (size_t n: {0, 1, 7, 31, 32, 33, 64, 100, 1000, 5000}) {
+            std::set<int> ref;
+            while (ref.size() < n) {
+                ref.insert(static_cast<int>(rng() % (4 * n + 1)));
+            }
+            FlatSets<int> set(ref.begin(), ref.end());
+            FlatSets<long, std::less<>, std::vector<long>> wide(ref.begin(), ref.end());
+            assert(std::equal(set.begin(), set.end(), ref.begin(), ref.end()));
+            for (int x = -2; x < static_cast<int>(4 * n + 3); x++) {
+                auto expected = ref.lower_bound(x);
+                size_t pos = std::distance(ref.begin(), expected);
+                assert(set.lower_bound(x) == set.begin() + pos);
+                assert(wide.lower_bound(static_cast<long>(x)) == wide.begin() + pos);
+                assert(set.contains(x) == (ref.count(x) == 1));
+            }
+            set.build_index();
+            for (int x = -2; x < static_cast<int>(4 * n + 3); x++) {
+                assert(set.contains(x) == (ref.count(x) == 1));
+            }
+        }
+
+        std::set<int> ref;
+        FlatSets<int> set;
+        for (int i = 0; i < 20000; i++) {
+            int x = static_cast<int>(rng() % 2000);
+            if (rng() % 3 == 0) {
+                assert(set.erase(x) == ref.erase(x));
+            } else {
+                assert(set.insert(x).second == ref.insert(x).second);
+            }
+        }
+        assert(std::equal(set.begin(), set.end(), ref.begin(), ref.end()));
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 批量插入: 排序去重后一次归并 */
+    {
+        FlatSets<int> set = {10, 20, 30};
+        std::vector<int> more = {25, 5, 20, 40, 5, 15};
+        set.insert(more.begin(), more.end());
+        printSet(set, "merged");
+        assert(set.size() == 7 && std::is_sorted(set.begin(), set.end()));
+        assert(std::adjacent_find(set.begin(), set.end()) == set.end());
+        set.insert({50, 60});
+        assert(set.size() == 9 && *set.rbegin() == 60);
+
+        FlatSets<std::string> words = {"pear", "apple"};
+        std::vector<std::string> extra = {"fig", "apple", "kiwi", "fig"};
+        words.insert(extra.begin(), extra.end());
+        printSet(words, "words");
+        assert(words.size() == 4 && *words.begin() == "apple");
+
+        // 字符串集合可以直接用string_view查找
+        std::string_view key = "kiwi";
+        assert(words.contains(key) && *words.find(key) == "kiwi" && !words.contains(std::string_view("plum")));
+        words.build_index();
+        assert(words.has_index() && words.contains(key) && !words.contains("zzz"));
+        words.insert("plum");
+        assert(!words.has_index() && words.contains("plum"));
+
+        // 输入是集合自身的元素, 扩容不会使它们失效
+        FlatSets<int> copy = set;
+        set.insert(set.begin(), set.end());
+        set.insert(set.begin() + 3, set.end());
+        assert(std::equal(set.begin(), set.end(), copy.begin(), copy.end()));
+
+        // 排序新元素时抛出异常, 原有元素不变
+        FlatSets<int, ThrowingLess> guarded = {1, 3, 5};
+        std::vector<int> bad = {4, -1, 2};
+        ThrowingLess::armed = true;
+        bool thrown = false;
+        try {
+            guarded.insert(bad.begin(), bad.end());
+        } catch (std::runtime_error const&) {
+            thrown = true;
+        }
+        ThrowingLess::armed = false;
+        assert(thrown && guarded.size() == 3 && *guarded.rbegin() == 5);
+
+        FlatSets<int> tagged(sorted_unique, more.begin(), more.begin());
+        tagged.insert(sorted_unique, set.begin(), set.end());
+        assert(tagged.size() == set.size());
+        Vectors<int> raw = std::move(tagged).extract();
+        assert(raw.size() == set.size() && tagged.empty());
+        FlatSets<int> adopted(sorted_unique, std::move(raw));
+        assert(adopted.size() == set.size() && adopted.contains(60));
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 与Sets互相转换 */
+    {
+        Sets<int> tree = {4, 2, 6, 1};
+        FlatSets<int> flat(tree);
+        assert(flat.size() == 4 && std::equal(flat.begin(), flat.end(), tree.begin(), tree.end()));
+        Sets<int> back = flat.to_sets();
+        assert(back.size() == 4 && std::equal(back.begin(), back.end(), tree.begin(), tree.end()));
+        back.insert(3);
+        assert(back.size() == 5 && back.contains(3));
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 查找性能与内存: FlatSets, 带索引的FlatSets, Sets */
+    {
+        constexpr int kCount = 1 << 20;
+        constexpr int kLookups = 1 << 21;
+        std::mt19937 rng(5);
+        std::vector<int> keys(kCount);
+        for (int& key: keys) {
+            key = static_cast<int>(rng() >> 1);
+        }
+        std::vector<int> probes(kLookups);
+        for (int i = 0; i < kLookups; i++) {
+            probes[i] = i % 2 == 0 ? keys[rng() % kCount] : static_cast<int>(rng() >> 1);
+        }
+        FlatSets<int> flat(keys.begin(), keys.end());
+        Sets<int> tree = flat.to_sets();
+        Sets<int> random_tree;
+        for (int key: keys) {
+            random_tree.insert(key);
+        }
+
+        size_t hits_flat = 0, hits_index = 0, hits_tree = 0, hits_random = 0;
+        long long flat_ms = timeMs([&] {
+            for (int x: probes) hits_flat += flat.contains(x);
+        });
+        flat.build_index();
+        long long index_ms = timeMs([&] {
+            for (int x: probes) hits_index += flat.contains(x);
+        });
+        long long tree_ms = timeMs([&] {
+            for (int x: probes) hits_tree += tree.contains(x);
+        });
+        long long random_ms = timeMs([&] {
+            for (int x: probes) hits_random += random_tree.contains(x);
+        });
+        assert(hits_flat == hits_index && hits_flat == hits_tree && hits_flat == hits_random);
+        std::cout << kLookups << " lookups in " << flat.size() << " ints (" << kernels::isa_name(kernels::active_isa())
+                  << "): FlatSets " << flat_ms << "ms, with index " << index_ms << "ms, Sets (bulk built) "
+                  << tree_ms << "ms, Sets (random inserts) " << random_ms << "ms" << std::endl;
+        std::cout << "bytes per key: FlatSets " << sizeof(int) << ", Sets " << sizeof(RBTreeNode<int>) << std::endl;
+    }
+    return 0;
+}
@@ -1,34 +1,393 @@
 #pragma once
+
+#include <iterator>
+#include <initializer_list>
+
 #include "utils/tree.hpp"
 
-template <class T, class compare = std::less<T>, class allocator = std::allocator<T>>
-class Sets : TreeBase<T> {
+/**
+ * 有序集合, 元素不可修改, iterator与const_iterator相同
+ * 默认比较器std::less<>是透明的, find/contains/count可以直接传入与T可比较的类型,
+ * 例如用std::string_view查找Sets<std::string>时不会构造临时的std::string
+ * 节点通过allocator成块申请, 见@code{NodePool}
+ */
+template <class T, class compare = std::less<>, class allocator = std::allocator<T>>
+class Sets : TreeBase<T, compare, allocator> {
 private:
-    using typename TreeBase<T>::const_iterator;
-    using iterator = const_iterator;
-    // using typename TreeBase<T>::const_iterator;
+    using Base = TreeBase<T, compare, allocator>;
 public:
+    using value_type = T;
+    using key_compare = compare;
+    using iterator = typename Base::const_iterator;
+    using const_iterator = typename Base::const_iterator;
+    using reverse_iterator = typename Base::const_reverse_iterator;
+    using const_reverse_iterator = typename Base::const_reverse_iterator;
+
     Sets() = default;
 
-    std::pair<iterator, bool> insert(T val) {
-        return TreeBase<T>::single_insert(val);
+    explicit Sets(compare const& comp, allocator const& alloc = allocator()) : Base(comp, alloc) {};
+
+    explicit Sets(allocator const& alloc) : Base(compare(), alloc) {};
+
+    /**
+     * 输入的值类型为T且按比较器严格递增时直接O(n)建树, 否则逐个插入
+     */
+    template<std::input_iterator InputIt>
+    Sets(InputIt first, InputIt last, compare const& comp = compare(), allocator const& alloc = allocator())
+        : Base(comp, alloc) {
+        insert(first, last);
+    }
+
+    /**
+     * 调用者保证输入严格递增, 跳过检查
+     */
+    template<std::forward_iterator InputIt>
+    Sets(sorted_unique_t, InputIt first, InputIt last, compare const& comp = compare(),
+         allocator const& alloc = allocator()) : Base(comp, alloc) {
+        this->M_build_sorted(first, std::distance(first, last));
+    }
+
+    Sets(std::initializer_list<T> list) : Sets(list.begin(), list.end()) {};
+
+    std::pair<iterator, bool> insert(T const& val) {
+        auto [node, inserted] = this->M_single_insert(val);
+        return {this->M_iter(node), inserted};
+    }
+
+    std::pair<iterator, bool> insert(T&& val) {
+        auto [node, inserted] = this->M_single_insert(std::move(val));
+        return {this->M_iter(node), inserted};
+    }
+
+    /**
+     * 集合为空且输入严格递增时O(n)建树, 节点来自同一块连续内存; 否则逐个插入
+     * 输入的值类型不是T时先构造出T再查找, 有序性和是否重复都要在转换之后才能判断
+     * @param first
+     * @param last
+     */
+    template<std::input_iterator InputIt>
+    void insert(InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt> && std::same_as<std::iter_value_t<InputIt>, T>) {
+            if (this->empty() && this->M_is_sorted(first, last, true)) {
+                this->M_build_sorted(first, std::distance(first, last));
+                return;
+            }
+        }
+        for (; first != last; ++first) {
+            if constexpr (std::same_as<std::iter_value_t<InputIt>, T>) {
+                this->M_single_insert(*first);
+            } else {
+                this->M_single_emplace(*first);
+            }
+        }
+    }
+
+    template<std::forward_iterator InputIt>
+    void insert(sorted_unique_t, InputIt first, InputIt last) {
+        if (this->empty()) {
+            this->M_build_sorted(first, std::distance(first, last));
+            return;
+        }
+        insert(first, last);
     }
 
-    iterator find(T val) {
-        return this->_M_find(val);
+    void insert(std::initializer_list<T> list) {
+        insert(list.begin(), list.end());
     }
 
-    const_iterator find(T val) const noexcept {
-        return this->_M_find(val);
+    /**
+     * 原地构造元素; 已存在相同值时新构造的元素被销毁
+     * @param args
+     * @return
+     */
+    template<class ...Args>
+    std::pair<iterator, bool> emplace(Args &&... args) {
+        auto [node, inserted] = this->M_single_emplace(std::forward<Args>(args)...);
+        return {this->M_iter(node), inserted};
+    }
+
+    /**
+     * 删除pos处的元素, 返回下一个元素; 指向其他元素的迭代器不受影响
+     * @param pos
+     * @return
+     */
+    iterator erase(const_iterator pos) {
+        return this->M_erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return this->M_erase(first, last);
+    }
+
+    size_t erase(T const& val) {
+        RBTreeNodeBase* node = this->M_find(val);
+        if (node == nullptr) return 0;
+        this->M_erase_node(node);
+        return 1;
+    }
+
+    /**
+     * 删除所有元素; 节点留在池中, 之后的插入不再申请内存
+     */
+    void clear() noexcept {
+        this->M_clear();
+    }
+
+    iterator find(T const& val) const {
+        return this->M_iter(this->M_find(val));
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    iterator find(K const& key) const {
+        return this->M_iter(this->M_find(key));
+    }
+
+    [[nodiscard]] bool contains(T const& val) const {
+        return this->M_find(val) != nullptr;
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    [[nodiscard]] bool contains(K const& key) const {
+        return this->M_find(key) != nullptr;
+    }
+
+    [[nodiscard]] size_t count(T const& val) const {
+        return contains(val) ? 1 : 0;
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    [[nodiscard]] size_t count(K const& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    iterator lower_bound(T const& val) const {
+        return this->M_iter(this->M_lower_bound(val));
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    iterator lower_bound(K const& key) const {
+        return this->M_iter(this->M_lower_bound(key));
+    }
+
+    iterator upper_bound(T const& val) const {
+        return this->M_iter(this->M_upper_bound(val));
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    iterator upper_bound(K const& key) const {
+        return this->M_iter(this->M_upper_bound(key));
+    }
+
+    using Base::size;
+    using Base::empty;
+    using Base::key_comp;
+    using Base::get_allocator;
+
+    iterator begin() const noexcept {
+        return Base::begin();
+    }
+
+    iterator end() const noexcept {
+        return Base::end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return Base::cbegin();
+    }
+
+    const_iterator cend() const noexcept {
+        return Base::cend();
+    }
+
+    reverse_iterator rbegin() const noexcept {
+        return Base::rbegin();
+    }
+
+    reverse_iterator rend() const noexcept {
+        return Base::rend();
     }
 };
 
-template <class T, class compare = std::less<T>, class allocator = std::allocator<T>>
-class MultiSet : TreeBase<T> {
+/**
+ * 允许重复元素的有序集合, 相同元素按插入顺序排列
+ */
+template <class T, class compare = std::less<>, class allocator = std::allocator<T>>
+class MultiSet : TreeBase<T, compare, allocator> {
 private:
-    using iterator = typename TreeBase<T>::iterator;
+    using Base = TreeBase<T, compare, allocator>;
 public:
-    iterator insert(int val) {
-        return this->multi_insert(val);
+    using value_type = T;
+    using key_compare = compare;
+    using iterator = typename Base::const_iterator;
+    using const_iterator = typename Base::const_iterator;
+    using reverse_iterator = typename Base::const_reverse_iterator;
+    using const_reverse_iterator = typename Base::const_reverse_iterator;
+
+    MultiSet() = default;
+
+    explicit MultiSet(compare const& comp, allocator const& alloc = allocator()) : Base(comp, alloc) {};
+
+    explicit MultiSet(allocator const& alloc) : Base(compare(), alloc) {};
+
+    /**
+     * 输入的值类型为T且按比较器有序时直接O(n)建树, 否则逐个插入
+     */
+    template<std::input_iterator InputIt>
+    MultiSet(InputIt first, InputIt last, compare const& comp = compare(), allocator const& alloc = allocator())
+        : Base(comp, alloc) {
+        insert(first, last);
     }
-};
\ No newline at end of file
+
+    MultiSet(std::initializer_list<T> list) : MultiSet(list.begin(), list.end()) {};
+
+    iterator insert(T const& val) {
+        return this->M_iter(this->M_multi_insert(val));
+    }
+
+    /**
+     * 与@code{Sets::insert(InputIt, InputIt)}相同, 只是允许相同的值
+     */
+    template<std::input_iterator InputIt>
+    void insert(InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt> && std::same_as<std::iter_value_t<InputIt>, T>) {
+            if (this->empty() && this->M_is_sorted(first, last, false)) {
+                this->M_build_sorted(first, std::distance(first, last));
+                return;
+            }
+        }
+        for (; first != last; ++first) {
+            this->M_multi_insert(*first);
+        }
+    }
+
+    void insert(std::initializer_list<T> list) {
+        insert(list.begin(), list.end());
+    }
+
+    iterator insert(T&& val) {
+        return this->M_iter(this->M_multi_insert(std::move(val)));
+    }
+
+    template<class ...Args>
+    iterator emplace(Args &&... args) {
+        return this->M_iter(this->M_multi_insert(std::forward<Args>(args)...));
+    }
+
+    iterator erase(const_iterator pos) {
+        return this->M_erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        return this->M_erase(first, last);
+    }
+
+    /**
+     * 删除所有等于val的元素, 返回删除的个数
+     */
+    size_t erase(T const& val) {
+        auto [first, last] = equal_range(val);
+        size_t count = std::distance(first, last);
+        this->M_erase(first, last);
+        return count;
+    }
+
+    void clear() noexcept {
+        this->M_clear();
+    }
+
+    /**
+     * 返回第一个等于val的元素
+     */
+    iterator find(T const& val) const {
+        return M_find_first(val);
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    iterator find(K const& key) const {
+        return M_find_first(key);
+    }
+
+    [[nodiscard]] bool contains(T const& val) const {
+        return this->M_find(val) != nullptr;
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    [[nodiscard]] bool contains(K const& key) const {
+        return this->M_find(key) != nullptr;
+    }
+
+    [[nodiscard]] size_t count(T const& val) const {
+        auto [first, last] = equal_range(val);
+        return std::distance(first, last);
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    [[nodiscard]] size_t count(K const& key) const {
+        auto [first, last] = equal_range(key);
+        return std::distance(first, last);
+    }
+
+    iterator lower_bound(T const& val) const {
+        return this->M_iter(this->M_lower_bound(val));
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    iterator lower_bound(K const& key) const {
+        return this->M_iter(this->M_lower_bound(key));
+    }
+
+    iterator upper_bound(T const& val) const {
+        return this->M_iter(this->M_upper_bound(val));
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    iterator upper_bound(K const& key) const {
+        return this->M_iter(this->M_upper_bound(key));
+    }
+
+    std::pair<iterator, iterator> equal_range(T const& val) const {
+        return {lower_bound(val), upper_bound(val)};
+    }
+
+    template<class K> requires TransparentCompare<compare>
+    std::pair<iterator, iterator> equal_range(K const& key) const {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    using Base::size;
+    using Base::empty;
+    using Base::key_comp;
+    using Base::get_allocator;
+
+    iterator begin() const noexcept {
+        return Base::begin();
+    }
+
+    iterator end() const noexcept {
+        return Base::end();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return Base::cbegin();
+    }
+
+    const_iterator cend() const noexcept {
+        return Base::cend();
+    }
+
+    reverse_iterator rbegin() const noexcept {
+        return Base::rbegin();
+    }
+
+    reverse_iterator rend() const noexcept {
+        return Base::rend();
+    }
+
+private:
+    template<class K>
+    iterator M_find_first(K const& key) const {
+        RBTreeNodeBase* node = this->M_lower_bound(key);
+        if (node == nullptr || this->m_comp(key, Base::S_val(node))) return end();
+        return this->M_iter(node);
+    }
+};
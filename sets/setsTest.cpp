@@ -1,6 +1,366 @@
+#include <set>
+#include <chrono>
+#include <random>
+#include <string>
+#include <cassert>
 #include <iostream>
+#include <numeric>
+#include <algorithm>
+#include <string_view>
+#include <vector>
 
 #include "sets.hpp"
 
+/** 统计分配次数, 用于确认查找不分配内存以及节点成块申请 */
+inline size_t g_allocations = 0;
 
-int main() {}
\ No newline at end of file
+template<class T>
+struct CountingAllocator : std::allocator<T> {
+    template<class U>
+    struct rebind {
+        using other = CountingAllocator<U>;
+    };
+
+    CountingAllocator() noexcept = default;
+
+    template<class U>
+    CountingAllocator(CountingAllocator<U> const&) noexcept {};
+
+    T* allocate(size_t n) {
+        g_allocations += 1;
+        return std::allocator<T>::allocate(n);
+    }
+};
+
+using CountedString = std::basic_string<char, std::char_traits<char>, CountingAllocator<char>>;
+
+/** 暴露TreeBase的红黑树检查 */
+template<class T, class Compare = std::less<>>
+struct TreeProbe : TreeBase<T, Compare> {
+    using TreeBase<T, Compare>::M_single_insert;
+    using TreeBase<T, Compare>::M_multi_insert;
+    using TreeBase<T, Compare>::M_verify;
+    using TreeBase<T, Compare>::M_find;
+    using TreeBase<T, Compare>::M_erase_node;
+    using TreeBase<T, Compare>::M_build_sorted;
+};
+
+static_assert(std::bidirectional_iterator<Sets<int>::iterator>);
+static_assert(std::bidirectional_iterator<TreeBase<int>::iterator>);
+static_assert(std::bidirectional_iterator<TreeBase<int>::const_reverse_iterator>);
+
+int main() {
+    /* 插入, 查找与双向遍历 */
+    {
+        Sets<int> set = {5, 3, 8, 1, 4};
+        auto [it, inserted] = set.insert(4);
+        assert(!inserted && *it == 4 && set.size() == 5);
+        assert(set.insert(7).second && set.size() == 6);
+        for (int x: set) {
+            std::cout << x << " ";
+        }
+        std::cout << std::endl;
+        assert(std::is_sorted(set.begin(), set.end()));
+        assert(*set.find(8) == 8 && set.find(6) == set.end());
+        assert(set.contains(1) && !set.contains(2) && set.count(3) == 1 && set.count(9) == 0);
+        assert(*set.lower_bound(6) == 7 && *set.upper_bound(7) == 8 && set.upper_bound(8) == set.end());
+
+        auto last = set.end();
+        --last;
+        assert(*last == 8);
+        int prev = 9;
+        for (auto rit = set.rbegin(); rit != set.rend(); ++rit) {
+            assert(*rit < prev);
+            prev = *rit;
+        }
+        assert(prev == 1);
+
+        Sets<int> empty;
+        assert(empty.begin() == empty.end() && empty.rbegin() == empty.rend() && empty.empty());
+
+        // 移动后源对象是可以继续使用的空集合, 迭代器跟着元素转移
+        auto seven = set.find(7);
+        Sets<int> moved(std::move(set));
+        assert(moved.size() == 6 && moved.find(7) == seven && std::next(seven) == moved.find(8));
+        assert(set.empty() && set.begin() == set.end() && !set.contains(7) && set.find(7) == set.end());
+        set.insert(2);
+        assert(set.size() == 1 && *set.begin() == 2);
+        set = std::move(moved);
+        assert(set.size() == 6 && *set.find(7) == 7);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 随机插入后与std::set比较, 并检查红黑树性质 */
+    {
+        std::mt19937 rng(42);
+        TreeProbe<int> tree;
+        std::set<int> ref;
+        for (int i = 0; i < 100000; i++) {
+            int x = static_cast<int>(rng() % 50000);
+            assert(tree.M_single_insert(x).second == ref.insert(x).second);
+        }
+        size_t height = tree.M_verify();
+        std::cout << "size: " << tree.size() << ", black height: " << height << std::endl;
+        assert(tree.size() == ref.size());
+        assert(std::equal(tree.begin(), tree.end(), ref.begin(), ref.end()));
+        assert(std::equal(tree.rbegin(), tree.rend(), ref.rbegin(), ref.rend()));
+
+        // 有序插入是最容易退化的情况
+        TreeProbe<int> ordered;
+        for (int i = 0; i < 1 << 16; i++) {
+            ordered.M_single_insert(i);
+        }
+        assert(ordered.M_verify() <= 17);
+
+        TreeProbe<int> multi;
+        for (int i = 0; i < 10000; i++) {
+            multi.M_multi_insert(static_cast<int>(rng() % 100));
+        }
+        multi.M_verify();
+        assert(multi.size() == 10000 && std::is_sorted(multi.begin(), multi.end()));
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 字符串集合: emplace, 移动插入, string_view查找不分配内存 */
+    {
+        Sets<CountedString> set;
+        CountedString key(40, 'k');
+        CountedString moved = key + "-moved";
+        set.insert(std::move(moved));
+        assert(moved.empty());
+        set.emplace(40, 'a');
+        set.insert(key);
+        assert(!set.emplace(key).second && set.size() == 3);
+        for (int i = 0; i < 1000; i++) {
+            set.emplace(CountedString(std::to_string(i)) + CountedString(40, 'x'));
+        }
+
+        std::string_view probe = key;
+        size_t before = g_allocations;
+        size_t hits = 0;
+        for (int i = 0; i < 1000; i++) {
+            hits += set.contains(probe);
+            hits += set.find(std::string_view(key).substr(0, 39)) != set.end();
+            hits += set.count("not there");
+        }
+        std::cout << "allocations during lookup: " << g_allocations - before << std::endl;
+        assert(g_allocations == before && hits == 1000);
+        assert(*set.find(probe) == key && *set.begin() == CountedString("0").append(40, 'x'));
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 自定义比较器与MultiSet */
+    {
+        Sets<int, std::greater<int>> desc;
+        for (int i = 0; i < 10; i++) {
+            desc.insert(i);
+        }
+        assert(desc.begin() == desc.find(9));
+        assert(std::is_sorted(desc.rbegin(), desc.rend()));
+        assert(desc.find(3) != desc.end());
+
+        MultiSet<std::string> multi;
+        for (auto s: {"b", "a", "b", "c", "b"}) {
+            multi.insert(s);
+        }
+        multi.emplace(3, 'z');
+        assert(multi.size() == 6 && multi.count("b") == 3 && multi.count(std::string_view("d")) == 0);
+        auto [first, last] = multi.equal_range("b");
+        assert(std::distance(first, last) == 3 && *first == "b" && *last == "c");
+        assert(multi.find("b") == first && multi.contains("zzz") && !multi.contains("y"));
+        for (auto const& s: multi) {
+            std::cout << s << " ";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 节点池: 成块申请, 相邻插入的节点在内存中相邻 */
+    {
+        constexpr int kCount = 1 << 18;
+        size_t before = g_allocations;
+        auto* set = new Sets<int, std::less<>, CountingAllocator<int>>();
+        for (int i = 0; i < kCount; i++) {
+            set->insert(i);
+        }
+        size_t chunks = g_allocations - before;
+        std::cout << "chunk allocations for " << kCount << " nodes: " << chunks << std::endl;
+        assert(chunks < 32);
+        auto it = set->begin();
+        int const* prev = &*it++;
+        size_t adjacent = 0;
+        for (; it != set->end(); ++it) {
+            adjacent += reinterpret_cast<char const *>(&*it) - reinterpret_cast<char const *>(prev) == sizeof(RBTreeNode<int>);
+            prev = &*it;
+        }
+        assert(adjacent > kCount * 0.99);
+        delete set;
+
+        std::mt19937 rng(7);
+        std::vector<int> keys(kCount);
+        for (int& key: keys) {
+            key = static_cast<int>(rng());
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        {
+            Sets<int> pooled;
+            for (int key: keys) {
+                pooled.insert(key);
+            }
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        {
+            std::set<int> ref;
+            for (int key: keys) {
+                ref.insert(key);
+            }
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        std::cout << "insert + destroy " << kCount << " random ints, Sets: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << "ms, std::set: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << "ms" << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 删除: 随机插入删除后与std::set比较, 并检查红黑树性质 */
+    {
+        std::mt19937 rng(3);
+        TreeProbe<int> tree;
+        std::set<int> ref;
+        for (int i = 0; i < 200000; i++) {
+            int x = static_cast<int>(rng() % 4096);
+            if (rng() % 2 == 0) {
+                assert(tree.M_single_insert(x).second == ref.insert(x).second);
+            } else if (RBTreeNodeBase* node = tree.M_find(x)) {
+                tree.M_erase_node(node);
+                assert(ref.erase(x) == 1);
+            } else {
+                assert(ref.count(x) == 0);
+            }
+            if (i % 10000 == 0) tree.M_verify();
+        }
+        tree.M_verify();
+        assert(std::equal(tree.begin(), tree.end(), ref.begin(), ref.end()));
+
+        Sets<std::string> set;
+        for (int i = 0; i < 100; i++) {
+            set.insert(std::to_string(i));
+        }
+        assert(set.erase("42") == 1 && set.erase("42") == 0 && set.size() == 99);
+        auto it = set.find("5");
+        auto kept = set.find("50");
+        it = set.erase(it);
+        assert(*it == "50" && it == kept);
+        it = set.erase(set.find("7"), set.find("9"));
+        assert(*it == "9" && !set.contains("8") && !set.contains("75") && set.contains("9"));
+        assert(set.erase(set.find("99")) == set.end() && *std::prev(set.end()) == "98");
+        set.erase(set.begin(), set.end());
+        assert(set.empty() && set.begin() == set.end());
+        set.emplace("again");
+        assert(set.size() == 1);
+        set.clear();
+        assert(set.empty());
+
+        MultiSet<int> multi;
+        for (int i = 0; i < 30; i++) {
+            multi.insert(i % 3);
+        }
+        assert(multi.erase(1) == 10 && multi.size() == 20 && multi.count(1) == 0);
+        multi.erase(multi.begin());
+        assert(multi.count(0) == 9 && *multi.begin() == 0);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 滑动窗口: 稳定之后插入删除不再调用分配器 */
+    {
+        constexpr int kWindow = 10000;
+        Sets<int, std::less<>, CountingAllocator<int>> window;
+        for (int i = 0; i < kWindow; i++) {
+            window.insert(i);
+        }
+        size_t before = g_allocations;
+        for (int i = kWindow; i < 20 * kWindow; i++) {
+            window.insert(i);
+            window.erase(i - kWindow);
+        }
+        std::cout << "allocations in steady state: " << g_allocations - before << std::endl;
+        assert(g_allocations == before && window.size() == kWindow && *window.begin() == 19 * kWindow);
+
+        window.clear();
+        for (int i = 0; i < kWindow; i++) {
+            window.insert(i);
+        }
+        assert(g_allocations == before);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 由有序输入O(n)建树 */
+    {
+        for (size_t n = 0; n < 300; n++) {
+            std::vector<int> keys(n);
+            std::iota(keys.begin(), keys.end(), 0);
+            TreeProbe<int> tree;
+            tree.M_build_sorted(keys.begin(), n);
+            tree.M_verify();
+            assert(std::equal(tree.begin(), tree.end(), keys.begin(), keys.end()));
+            if (n > 0) {
+                tree.M_single_insert(-1);
+                tree.M_erase_node(tree.M_find(static_cast<int>(n / 2)));
+                tree.M_verify();
+            }
+        }
+
+        constexpr int kCount = 1 << 20;
+        std::vector<int> keys(kCount);
+        for (int i = 0; i < kCount; i++) {
+            keys[i] = i * 2;
+        }
+        size_t before = g_allocations;
+        auto t0 = std::chrono::steady_clock::now();
+        Sets<int, std::less<>, CountingAllocator<int>> bulk(keys.begin(), keys.end());
+        auto t1 = std::chrono::steady_clock::now();
+        Sets<int> one_by_one;
+        for (int key: keys) {
+            one_by_one.insert(key);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        std::cout << "build from " << kCount << " sorted keys, bulk: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << "ms, one by one: "
+                  << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << "ms" << std::endl;
+        assert(g_allocations - before == 1 && bulk.size() == kCount);
+        assert(std::equal(bulk.begin(), bulk.end(), keys.begin(), keys.end()));
+        assert(bulk.contains(1024) && !bulk.contains(1025));
+        bulk.insert(1025);
+        bulk.erase(0);
+        assert(bulk.size() == kCount && *bulk.find(1025) == 1025);
+
+        Sets<int> tagged(sorted_unique, keys.begin(), keys.begin() + 100);
+        assert(tagged.size() == 100 && tagged.contains(198));
+        tagged.insert(sorted_unique, keys.begin(), keys.end());
+        assert(tagged.size() == kCount);
+
+        // 无序或有重复的输入逐个插入
+        Sets<int> unsorted = {3, 1, 2, 2};
+        assert(unsorted.size() == 3 && *unsorted.find(1) == 1);
+        std::vector<std::string> words = {"b", "a", "c"};
+        Sets<std::string> from_words(words.begin(), words.end());
+        assert(from_words.size() == 3 && from_words.contains("a"));
+
+        // 值类型不是T时按转换之后的值插入: 1.2和1.7都变成1, 按地址递增的指针转换成字符串之后并不有序
+        std::vector<double> reals = {1.2, 1.7, 2.5};
+        Sets<int> truncated(reals.begin(), reals.end());
+        assert(truncated.size() == 2 && *truncated.begin() == 1);
+        char const text[] = "pear\0apple\0fig";
+        std::vector<char const*> pointers = {text, text + 5, text + 11};
+        Sets<std::string> from_pointers(pointers.begin(), pointers.end());
+        MultiSet<std::string> multi_pointers(pointers.begin(), pointers.end());
+        assert(std::is_sorted(from_pointers.begin(), from_pointers.end()) && *from_pointers.begin() == "apple");
+        assert(std::is_sorted(multi_pointers.begin(), multi_pointers.end()) && multi_pointers.count("fig") == 1);
+        assert(from_pointers.contains("pear") && !from_pointers.contains("kiwi"));
+
+        MultiSet<int> multi = {1, 1, 2, 2, 2, 3};
+        assert(multi.size() == 6 && multi.count(2) == 3);
+        multi.insert({2, 0});
+        assert(multi.count(2) == 4 && *multi.begin() == 0);
+    }
+}
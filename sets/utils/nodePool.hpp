@@ -0,0 +1,149 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+/**
+ * 树节点的slab池, 每棵树独占一个
+ * 1. 节点从成块申请的chunk中按顺序切出, 一起插入的节点在内存中也相邻, 遍历时局部性更好
+ * 2. 释放的节点进入空闲链表, 之后的分配优先复用, 不再调用分配器
+ * 3. 整体释放只需归还各个chunk, 开销与chunk数成正比
+ * chunk通过Alloc(重新绑定到槽位类型)申请; 每个chunk的第一个槽位存放chunk链表的信息
+ * @tparam Node
+ * @tparam Alloc 任意值类型的分配器, 内部rebind
+ */
+template<class Node, class Alloc = std::allocator<Node>>
+class NodePool {
+private:
+    struct alignas(Node) Slot {
+        unsigned char m_bytes[sizeof(Node)];
+    };
+
+    struct ChunkHeader {
+        Slot* m_next;
+        size_t m_count; // 包括头部所在的槽位
+    };
+    static_assert(sizeof(ChunkHeader) <= sizeof(Slot));
+
+    using SlotAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Slot>;
+    using SlotTraits = std::allocator_traits<SlotAlloc>;
+
+    /* 第一个chunk约4KB, 之后每次翻倍, 最大约1MB */
+    static constexpr size_t kMinChunk = std::max<size_t>(4096 / sizeof(Slot), 8);
+    static constexpr size_t kMaxChunk = std::max<size_t>((1 << 20) / sizeof(Slot), kMinChunk);
+
+    [[no_unique_address]] SlotAlloc m_alloc;
+    Slot* m_chunks;   // chunk链表
+    Slot* m_free;     // 回收节点的链表, next指针直接存放在槽位中
+    Slot* m_cursor;   // 当前chunk中尚未切出的部分
+    Slot* m_end;
+    size_t m_next_chunk;
+
+public:
+    NodePool() : NodePool(Alloc()) {};
+
+    explicit NodePool(Alloc const& alloc) noexcept
+        : m_alloc(alloc), m_chunks(nullptr), m_free(nullptr), m_cursor(nullptr), m_end(nullptr),
+          m_next_chunk(kMinChunk) {};
+
+    NodePool(NodePool const&) = delete;
+    NodePool& operator=(NodePool const&) = delete;
+
+    NodePool(NodePool &&that) noexcept
+        : m_alloc(std::move(that.m_alloc)), m_chunks(that.m_chunks), m_free(that.m_free),
+          m_cursor(that.m_cursor), m_end(that.m_end), m_next_chunk(that.m_next_chunk) {
+        that.m_chunks = that.m_free = that.m_cursor = that.m_end = nullptr;
+        that.m_next_chunk = kMinChunk;
+    }
+
+    NodePool& operator=(NodePool &&that) noexcept {
+        swap(that);
+        return *this;
+    }
+
+    ~NodePool() {
+        release();
+    }
+
+    void swap(NodePool& that) noexcept {
+        std::swap(m_alloc, that.m_alloc);
+        std::swap(m_chunks, that.m_chunks);
+        std::swap(m_free, that.m_free);
+        std::swap(m_cursor, that.m_cursor);
+        std::swap(m_end, that.m_end);
+        std::swap(m_next_chunk, that.m_next_chunk);
+    }
+
+    /**
+     * 返回一个未构造的节点槽位
+     * @return
+     */
+    Node* allocate() {
+        Slot* slot;
+        if (m_free != nullptr) {
+            slot = m_free;
+            std::memcpy(&m_free, static_cast<void const *>(slot), sizeof(Slot*));
+        } else {
+            if (m_cursor == m_end) [[unlikely]] M_new_chunk();
+            slot = m_cursor++;
+        }
+        return reinterpret_cast<Node *>(slot);
+    }
+
+    /**
+     * 单独申请一个恰好容纳n个节点的chunk, 返回其中连续的n个槽位; 批量建树时使用
+     * @param n
+     * @return
+     */
+    Node* allocate_bulk(size_t n) {
+        Slot* chunk = SlotTraits::allocate(m_alloc, n + 1);
+        ChunkHeader header{m_chunks, n + 1};
+        std::memcpy(static_cast<void *>(chunk), &header, sizeof(ChunkHeader));
+        m_chunks = chunk;
+        return reinterpret_cast<Node *>(chunk + 1);
+    }
+
+    /**
+     * 归还节点槽位, 调用前节点必须已经析构
+     * @param node
+     */
+    void deallocate(Node* node) noexcept {
+        auto* slot = reinterpret_cast<Slot *>(node);
+        std::memcpy(static_cast<void *>(slot), &m_free, sizeof(Slot*));
+        m_free = slot;
+    }
+
+    /**
+     * 归还所有chunk, 之前分配的节点全部失效; 不会析构节点
+     */
+    void release() noexcept {
+        while (m_chunks != nullptr) {
+            ChunkHeader header;
+            std::memcpy(&header, static_cast<void const *>(m_chunks), sizeof(ChunkHeader));
+            SlotTraits::deallocate(m_alloc, m_chunks, header.m_count);
+            m_chunks = header.m_next;
+        }
+        m_free = m_cursor = m_end = nullptr;
+        m_next_chunk = kMinChunk;
+    }
+
+    [[nodiscard]] Alloc get_allocator() const {
+        return Alloc(m_alloc);
+    }
+
+private:
+    void M_new_chunk() {
+        size_t count = m_next_chunk;
+        Slot* chunk = SlotTraits::allocate(m_alloc, count);
+        ChunkHeader header{m_chunks, count};
+        std::memcpy(static_cast<void *>(chunk), &header, sizeof(ChunkHeader));
+        m_chunks = chunk;
+        m_cursor = chunk + 1;
+        m_end = chunk + count;
+        m_next_chunk = std::min(count * 2, kMaxChunk);
+    }
+};
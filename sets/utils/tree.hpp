@@ -1,10 +1,16 @@
 #pragma once
 
+#include <bit>
 #include <memory>
 #include <utility>
-#include <iostream>
 #include <cassert>
+#include <cstddef>
 #include <iterator>
+#include <concepts>
+#include <functional>
+#include <type_traits>
+
+#include "nodePool.hpp"
 
 enum RBTree_color {
     BLACK,
@@ -15,174 +21,274 @@ enum RBDirection {
     RIGHT
 };
 
-struct RBTreeNode {
-    RBTreeNode* left;
-    RBTreeNode* right;
-    RBTreeNode *parent;
-    RBTreeNode** p_parent; // 父节点中指向本节点的指针
+/**
+ * 比较器带有is_transparent时, 查找可以直接使用与T可比较的其他类型(如用std::string_view查std::string)
+ */
+template<class Compare>
+concept TransparentCompare = requires { typename Compare::is_transparent; };
+
+/**
+ * 标记输入已经按比较器严格递增排列, 构造时不再检查
+ */
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+/**
+ * 节点中与值类型无关的部分, 迭代器和旋转只依赖这一部分
+ */
+struct RBTreeNodeBase {
+    RBTreeNodeBase* left;
+    RBTreeNodeBase* right;
+    RBTreeNodeBase *parent;
+    RBTreeNodeBase** p_parent; // 父节点中指向本节点的指针, 根节点指向TreeRoot::m_node
     RBTree_color color;
-
-    int val;
 };
 
-template <bool>
-struct RBTreeIteratorBase;
+template<class T>
+struct RBTreeNode : RBTreeNodeBase {
+    T val;
+};
 
-template<>
-struct RBTreeIteratorBase<false> {
+template <bool Reverse>
+struct RBTreeIteratorBase {
+protected:
     union {
-        RBTreeNode* node;
-        RBTreeNode** p_root;
+        RBTreeNodeBase* node;
+        RBTreeNodeBase** p_root; // off_by_one时使用, 指向TreeRoot::m_node, 从尾后位置回退时需要它找到最后一个节点
     };
     bool off_by_one;
 
-public:
+    /* 正向迭代器沿RIGHT前进, 反向迭代器沿LEFT前进 */
+    static constexpr RBDirection kForward = Reverse ? LEFT : RIGHT;
+    static constexpr RBDirection kBackward = Reverse ? RIGHT : LEFT;
 
-    template<class, bool>
-    friend struct RBTreeIterator;
+    RBTreeIteratorBase() noexcept : node(nullptr), off_by_one(false) {}
+    explicit RBTreeIteratorBase(RBTreeNodeBase *node) noexcept : node(node), off_by_one(false) {}
+    explicit RBTreeIteratorBase(RBTreeNodeBase **p_root) noexcept : p_root(p_root), off_by_one(true) {}
 
-    RBTreeIteratorBase(bool offByOne, RBTreeNode *node) : off_by_one(offByOne), node(node) {}
-    explicit RBTreeIteratorBase() : node(nullptr), off_by_one(false) {}
-
-    bool operator==(RBTreeIteratorBase const& that) const noexcept {
-        return that.off_by_one == off_by_one || node == that.node;
-    }
-    bool operator!=(RBTreeIteratorBase const& that) const noexcept {
-        return this != &that;
+    static RBTreeNodeBase** S_child(RBTreeNodeBase* node, RBDirection dir) noexcept {
+        return dir == LEFT ? &node->left : &node->right;
     }
-    void operator++() noexcept {
+
+    /**
+     * 移动到dir方向上的相邻节点; 越过最后一个节点时变为尾后位置
+     * @param dir
+     */
+    void M_step(RBDirection dir) noexcept {
         assert(!off_by_one);
         assert(node);
-        if (node->right != nullptr) {
-            node = node->right;
-            while (node->left != nullptr) {
-                node = node->left;
-            }
-        } else {
-            // 不断向上寻找离自己差值最小的下一个数
-            while (node->parent != nullptr && node->p_parent == &node->parent->right) {
-                node = node->parent;
-            }
-            if (node->parent == nullptr) {
-                off_by_one = true;
-                return;
+        RBDirection other = dir == LEFT ? RIGHT : LEFT;
+        RBTreeNodeBase* curr = node;
+        if (*S_child(curr, dir) != nullptr) {
+            curr = *S_child(curr, dir);
+            while (*S_child(curr, other) != nullptr) {
+                curr = *S_child(curr, other);
             }
-            node = node->parent;
+            node = curr;
+            return;
+        }
+        // 不断向上寻找离自己差值最小的下一个数
+        while (curr->parent != nullptr && curr->p_parent == S_child(curr->parent, dir)) {
+            curr = curr->parent;
+        }
+        if (curr->parent == nullptr) {
+            p_root = curr->p_parent;
+            off_by_one = true;
+            return;
         }
+        node = curr->parent;
     }
-    void operator--() noexcept {
+
+    void M_increment() noexcept {
+        M_step(kForward);
+    }
+
+    void M_decrement() noexcept {
         if (off_by_one) {
+            // 从尾后位置回到最后一个节点
+            RBTreeNodeBase* curr = *p_root;
+            assert(curr);
+            while (*S_child(curr, kForward) != nullptr) {
+                curr = *S_child(curr, kForward);
+            }
+            node = curr;
             off_by_one = false;
             return;
         }
-        if (node->left != nullptr) {
-            node = node->left;
-            while (node->right != nullptr) {
-                node = node->right;
-            }
-        } else {
-            // 不断向上寻找离自己差值最小的下一个数
-            while (node->parent != nullptr && node->p_parent == &node->parent->left) {
-                node = node->parent;
-            }
-            if (node->parent == nullptr) {
-                off_by_one = true;
-                return;
-            }
-            node = node->parent;
-        }
+        M_step(kBackward);
     }
-};
 
-template<>
-struct RBTreeIteratorBase<true> : RBTreeIteratorBase<false> {
-protected:
-    using RBTreeIteratorBase<false>::RBTreeIteratorBase;
+    [[nodiscard]] bool M_equal(RBTreeIteratorBase const& that) const noexcept {
+        if (off_by_one != that.off_by_one) return false;
+        return off_by_one ? p_root == that.p_root : node == that.node;
+    }
 };
 
 template<class T, bool Reverse>
 struct RBTreeIterator : protected RBTreeIteratorBase<Reverse> {
+    template<class, bool>
+    friend struct RBTreeIterator;
+
+    template<class, class, class>
+    friend struct TreeBase;
+
 protected:
     using RBTreeIteratorBase<Reverse>::RBTreeIteratorBase;
 
-    RBTreeIterator(RBTreeNode* node, bool off_by_one) : RBTreeIteratorBase<Reverse>(node, off_by_one) {};
 public:
-    template<class T0 = T>
-    explicit operator std::enable_if_t<std::is_const_v<T0>, RBTreeIterator<std::remove_const_t<T0>, Reverse>>()
-    const noexcept {
-        if (!this->off_by_one) {
-            return this->node;
-        } else {
-            return this->p_root;
-        }
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::remove_const_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    RBTreeIterator() noexcept = default;
+
+    /**
+     * iterator可以隐式转换为const_iterator
+     */
+    template<class U> requires (std::is_const_v<T> && std::is_same_v<U const, T>)
+    RBTreeIterator(RBTreeIterator<U, Reverse> const& that) noexcept
+        : RBTreeIteratorBase<Reverse>(static_cast<RBTreeIteratorBase<Reverse> const&>(that)) {}
+
+    T& operator*() const noexcept {
+        return static_cast<RBTreeNode<value_type> *>(this->node)->val;
     }
 
-    template<class T0 = T>
-    explicit operator std::enable_if_t<!std::is_const_v<T0>, RBTreeIterator<std::add_const_t<T0>, Reverse>>()
-    const noexcept {
-        if (!this->off_by_one) {
-            return this->node;
-        } else {
-            return this->p_root;
-        }
+    T* operator->() const noexcept {
+        return &**this;
     }
-    RBTreeIterator &operator++() const noexcept {
-        RBTreeIteratorBase<Reverse>::operator++();
+
+    RBTreeIterator &operator++() noexcept {
+        this->M_increment();
         return *this;
     }
 
-    RBTreeIterator &operator--() const noexcept {
-        RBTreeIteratorBase<Reverse>::operator--();
+    RBTreeIterator &operator--() noexcept {
+        this->M_decrement();
         return *this;
     }
 
-    RBTreeIterator operator++(int) const noexcept {
+    RBTreeIterator operator++(int) noexcept {
         RBTreeIterator temp = *this;
         ++*this;
         return temp;
     }
 
-    RBTreeIterator operator--(int) const noexcept {
+    RBTreeIterator operator--(int) noexcept {
         RBTreeIterator temp = *this;
         --*this;
         return temp;
     }
+
+    friend bool operator==(RBTreeIterator const& lhs, RBTreeIterator const& rhs) noexcept {
+        return lhs.M_equal(rhs);
+    }
 };
 
 struct TreeRoot {
-    RBTreeNode* m_node;
-    TreeRoot() noexcept : m_node(nullptr) {};
+    RBTreeNodeBase* m_node;
+    size_t m_size;
+    TreeRoot() noexcept : m_node(nullptr), m_size(0) {};
 };
 
-template<class T>
+/**
+ * 红黑树, 按Compare排序
+ * 根放在单独分配的TreeRoot中, 尾后迭代器指向它, 因此移动树不会使迭代器失效
+ * 节点从每棵树自己的@code{NodePool}中分配
+ * @tparam T
+ * @tparam Compare
+ * @tparam Alloc 节点chunk通过它(rebind之后)申请
+ */
+template<class T, class Compare = std::less<>, class Alloc = std::allocator<T>>
 struct TreeBase {
 protected:
+    using Node = RBTreeNode<T>;
+
     TreeRoot *m_block;
+    [[no_unique_address]] Compare m_comp;
+    NodePool<Node, Alloc> m_pool;
 public:
     using iterator = RBTreeIterator<T, false>;
     using reverse_iterator = RBTreeIterator<T, true>;
     using const_iterator = RBTreeIterator<T const, false>;
     using const_reverse_iterator = RBTreeIterator<T const, true>;
 
-    TreeBase() noexcept : m_block(new TreeRoot) {};
+    TreeBase() : m_block(new TreeRoot), m_comp(), m_pool() {};
 
-    TreeBase(TreeBase &&that) noexcept : m_block(that.m_block) {
-        that.m_block = nullptr;
+    explicit TreeBase(Compare const& comp, Alloc const& alloc = Alloc())
+        : m_block(new TreeRoot), m_comp(comp), m_pool(alloc) {};
+
+    /**
+     * 源对象换上一个新的空根, 之后仍然是可以使用的空树; 指向原来元素的迭代器(包括尾后迭代器)跟着树一起转移
+     * 申请新的根可能抛出异常, 因此不是noexcept
+     */
+    TreeBase(TreeBase &&that) : TreeBase(that.m_comp, that.m_pool.get_allocator()) {
+        std::swap(m_block, that.m_block);
+        m_pool.swap(that.m_pool);
     }
 
     TreeBase& operator=(TreeBase &&that) noexcept {
         std::swap(that.m_block, m_block);
+        std::swap(that.m_comp, m_comp);
+        m_pool.swap(that.m_pool);
         return *this;
     }
 
+    /**
+     * T可平凡析构时不遍历节点, 直接归还整个chunk
+     */
+    ~TreeBase() {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            S_destroy_values(m_block->m_node);
+        }
+        m_pool.release();
+        delete m_block;
+    }
+
 protected:
-    [[nodiscard]] RBTreeNode* M_find(int val) const noexcept {
-        RBTreeNode* curr = m_block->m_node;
+    template<class ...Args>
+    Node* M_create_node(Args &&... args) {
+        Node* node = m_pool.allocate();
+        try {
+            ::new (static_cast<void *>(node)) Node{{nullptr, nullptr, nullptr, nullptr, RED}, T(std::forward<Args>(args)...)};
+        } catch (...) {
+            m_pool.deallocate(node);
+            throw;
+        }
+        return node;
+    }
+
+    void M_destroy_node(RBTreeNodeBase* node) noexcept {
+        std::destroy_at(static_cast<Node *>(node));
+        m_pool.deallocate(static_cast<Node *>(node));
+    }
+
+    /**
+     * 只析构子树中的值, 不归还节点
+     */
+    static void S_destroy_values(RBTreeNodeBase* node) noexcept {
+        while (node != nullptr) {
+            S_destroy_values(node->left);
+            std::destroy_at(&static_cast<Node *>(node)->val);
+            node = node->right;
+        }
+    }
+
+    static T const& S_val(RBTreeNodeBase const* node) noexcept {
+        return static_cast<Node const *>(node)->val;
+    }
+
+    template<class K>
+    [[nodiscard]] RBTreeNodeBase* M_find(K const& key) const {
+        RBTreeNodeBase* curr = m_block->m_node;
         while (curr != nullptr) {
-            if (curr->val < val) {
+            if (m_comp(S_val(curr), key)) {
                 curr = curr->right;
                 continue;
-            } else if (curr->val > val) {
+            } else if (m_comp(key, S_val(curr))) {
                 curr = curr->left;
                 continue;
             }
@@ -191,8 +297,42 @@ protected:
         return nullptr;
     }
 
-    [[nodiscard]] RBTreeNode* Min_Node() const noexcept {
-        RBTreeNode* curr = m_block->m_node;
+    /**
+     * 第一个不小于key的节点, 不存在时返回nullptr
+     */
+    template<class K>
+    [[nodiscard]] RBTreeNodeBase* M_lower_bound(K const& key) const {
+        RBTreeNodeBase *curr = m_block->m_node, *res = nullptr;
+        while (curr != nullptr) {
+            if (m_comp(S_val(curr), key)) {
+                curr = curr->right;
+            } else {
+                res = curr;
+                curr = curr->left;
+            }
+        }
+        return res;
+    }
+
+    /**
+     * 第一个大于key的节点, 不存在时返回nullptr
+     */
+    template<class K>
+    [[nodiscard]] RBTreeNodeBase* M_upper_bound(K const& key) const {
+        RBTreeNodeBase *curr = m_block->m_node, *res = nullptr;
+        while (curr != nullptr) {
+            if (m_comp(key, S_val(curr))) {
+                res = curr;
+                curr = curr->left;
+            } else {
+                curr = curr->right;
+            }
+        }
+        return res;
+    }
+
+    [[nodiscard]] RBTreeNodeBase* Min_Node() const noexcept {
+        RBTreeNodeBase* curr = m_block->m_node;
         if (curr != nullptr) {
             while (curr->left != nullptr) {
                 curr = curr->left;
@@ -201,8 +341,8 @@ protected:
         return curr;
     }
 
-    [[nodiscard]] RBTreeNode* Max_Node() const noexcept {
-        RBTreeNode* curr = m_block->m_node;
+    [[nodiscard]] RBTreeNodeBase* Max_Node() const noexcept {
+        RBTreeNodeBase* curr = m_block->m_node;
         if (curr != nullptr) {
             while (curr->right != nullptr) {
                 curr = curr->right;
@@ -211,9 +351,9 @@ protected:
         return curr;
     }
 
-    static void M_rotate_right(RBTreeNode* target) noexcept {
-        RBTreeNode *left = target->left;
-        target->right = left->right;
+    static void M_rotate_right(RBTreeNodeBase* target) noexcept {
+        RBTreeNodeBase *left = target->left;
+        target->left = left->right;
         if (left->right != nullptr) {
             left->right->parent = target;
             left->right->p_parent = &target->left;
@@ -226,9 +366,9 @@ protected:
         target->p_parent = &left->right;
     }
 
-    static void M_rotate_left(RBTreeNode* target) noexcept {
+    static void M_rotate_left(RBTreeNodeBase* target) noexcept {
         // 获取 target 的右子节点
-        RBTreeNode *right = target->right;
+        RBTreeNodeBase *right = target->right;
 
         // 将 target 的右子节点的左子节点连接到 target 的右子节点
         target->right = right->left;
@@ -252,164 +392,477 @@ protected:
         target->p_parent = &right->left; // 更新 target 的 p_parent
     }
 
-    static void M_fix_violation(RBTreeNode* target) noexcept {
+    static void M_fix_violation(RBTreeNodeBase* target) noexcept {
         while (true) {
-            RBTreeNode* parent = target->parent;
+            RBTreeNodeBase* parent = target->parent;
             if (parent == nullptr) {
                 target->color = BLACK;
                 return;
             }
-            if (target->color == RED || parent->color == RED) return;
+            if (parent->color == BLACK) return;
 
-            RBTreeNode *uncle, *grandpa = parent->parent;
+            // parent是红色, 所以不是根, grandpa一定存在
+            RBTreeNodeBase *uncle, *grandpa = parent->parent;
 
-            RBDirection parent_direction = parent == grandpa->left ? LEFT : RIGHT;
+            RBDirection parent_direction = parent->p_parent == &grandpa->left ? LEFT : RIGHT;
             if (parent_direction == LEFT) {
                 uncle = grandpa->right;
             } else uncle = grandpa->left;
 
-            RBDirection node_direction = target == parent->left ? LEFT : RIGHT;
-            if (uncle->color == RED) {
-                // 1. uncle是红色节点
+            if (uncle != nullptr && uncle->color == RED) {
+                // 1. uncle是红色节点, 颜色下推后继续检查grandpa
                 uncle->color = BLACK;
                 parent->color = BLACK;
                 grandpa->color = RED;
-                TreeBase::M_fix_violation(grandpa);
+                target = grandpa;
+                continue;
+            }
+            RBDirection node_direction = target->p_parent == &parent->left ? LEFT : RIGHT;
+            if (parent_direction == LEFT && node_direction == RIGHT) {
+                // 2. uncle是黑色节点 && parent和node在不同侧(LR), 先转成LL
+                TreeBase::M_rotate_left(parent);
+                std::swap(target, parent);
+            } else if (parent_direction == RIGHT && node_direction == LEFT) {
+                // 2. uncle是黑色节点 && parent和node在不同侧(RL), 先转成RR
+                TreeBase::M_rotate_right(parent);
+                std::swap(target, parent);
+            }
+            // 3. uncle是黑色节点 && parent和node在同侧(LL/RR)
+            if (parent_direction == LEFT) {
+                TreeBase::M_rotate_right(grandpa);
             } else {
-                if (parent_direction == LEFT && node_direction == LEFT) {
-                    // 2. uncle是黑色节点 && parent和node在同侧(LL)
-                    TreeBase::M_rotate_right(grandpa);
-                    std::swap(parent->color, grandpa->color);
-                    if (grandpa->color == RED) M_fix_violation(grandpa);
-                } else if (parent_direction == RIGHT && node_direction == RIGHT) {
-                    // 2. uncle是黑色节点 && parent和node在同侧(RR)
-                    TreeBase::M_rotate_left(grandpa);
-                    std::swap(parent->color, grandpa->color);
-                    if (grandpa->color == RED) M_fix_violation(grandpa);
-                } else if (parent_direction == LEFT && node_direction == RIGHT) {
-                    // 2. uncle是黑色节点 && parent和node在不同侧(LR)
-                    TreeBase::M_rotate_right(parent);
-                } else if (parent_direction == RIGHT && node_direction == LEFT) {
-                    // 2. uncle是黑色节点 && parent和node在不同侧(RL)
-                    TreeBase::M_rotate_left(parent);
-                }
+                TreeBase::M_rotate_left(grandpa);
             }
+            parent->color = BLACK;
+            grandpa->color = RED;
+            return;
         }
     }
 
-    RBTreeNode* M_single_insert(int val) {
-        RBTreeNode** p_parent = &m_block->m_node;
-        RBTreeNode* parent = nullptr;
-        while (*p_parent != nullptr) {
-            parent = *p_parent;
-            if (parent->val < val) {
-                p_parent = &parent->right;
-                continue;
-            } else if (parent->val > val) {
-                p_parent  = &parent->left;
-                continue;
-            }
-            return parent; // 找到了相同值的节点
-        }
-        auto* new_node = new RBTreeNode;
-        new_node->val = val;
-        new_node->right = nullptr;
+    /**
+     * 把新节点挂到p_parent上并重新平衡
+     */
+    void M_link(RBTreeNodeBase* new_node, RBTreeNodeBase* parent, RBTreeNodeBase** p_parent) noexcept {
         new_node->left = nullptr;
+        new_node->right = nullptr;
         new_node->color = RED;
-
         new_node->parent = parent;
         new_node->p_parent = p_parent;
         *p_parent = new_node;
         TreeBase::M_fix_violation(new_node);
+        m_block->m_size += 1;
+    }
+
+    /**
+     * 删除黑色节点后, x所在的子树少了一个黑色节点; x可能为nullptr, 所以单独传入它的父节点
+     */
+    static void M_erase_fixup(RBTreeNodeBase* x, RBTreeNodeBase* x_parent) noexcept {
+        while (x_parent != nullptr && (x == nullptr || x->color == BLACK)) {
+            if (x == x_parent->left) {
+                // 兄弟节点一定存在, 否则两侧黑高不相等
+                RBTreeNodeBase* sibling = x_parent->right;
+                if (sibling->color == RED) {
+                    // 1. 兄弟是红色, 旋转后转化为兄弟是黑色的情况
+                    sibling->color = BLACK;
+                    x_parent->color = RED;
+                    TreeBase::M_rotate_left(x_parent);
+                    sibling = x_parent->right;
+                }
+                if (S_is_black(sibling->left) && S_is_black(sibling->right)) {
+                    // 2. 兄弟的两个子节点都是黑色, 兄弟变红后问题上移一层
+                    sibling->color = RED;
+                    x = x_parent;
+                    x_parent = x_parent->parent;
+                    continue;
+                }
+                if (S_is_black(sibling->right)) {
+                    // 3. 兄弟的近侧子节点是红色, 转化为远侧子节点是红色
+                    sibling->left->color = BLACK;
+                    sibling->color = RED;
+                    TreeBase::M_rotate_right(sibling);
+                    sibling = x_parent->right;
+                }
+                // 4. 兄弟的远侧子节点是红色, 旋转后补上缺少的黑色节点
+                sibling->color = x_parent->color;
+                x_parent->color = BLACK;
+                sibling->right->color = BLACK;
+                TreeBase::M_rotate_left(x_parent);
+                return;
+            } else {
+                RBTreeNodeBase* sibling = x_parent->left;
+                if (sibling->color == RED) {
+                    sibling->color = BLACK;
+                    x_parent->color = RED;
+                    TreeBase::M_rotate_right(x_parent);
+                    sibling = x_parent->left;
+                }
+                if (S_is_black(sibling->left) && S_is_black(sibling->right)) {
+                    sibling->color = RED;
+                    x = x_parent;
+                    x_parent = x_parent->parent;
+                    continue;
+                }
+                if (S_is_black(sibling->left)) {
+                    sibling->right->color = BLACK;
+                    sibling->color = RED;
+                    TreeBase::M_rotate_left(sibling);
+                    sibling = x_parent->left;
+                }
+                sibling->color = x_parent->color;
+                x_parent->color = BLACK;
+                sibling->left->color = BLACK;
+                TreeBase::M_rotate_right(x_parent);
+                return;
+            }
+        }
+        if (x != nullptr) x->color = BLACK;
+    }
+
+    static bool S_is_black(RBTreeNodeBase const* node) noexcept {
+        return node == nullptr || node->color == BLACK;
+    }
+
+    /**
+     * 把target从树中摘下并重新平衡, 不析构也不归还节点
+     * 有两个子节点时用后继节点顶替target的位置(而不是交换值), 所以指向其他节点的迭代器仍然有效
+     */
+    void M_unlink(RBTreeNodeBase* target) noexcept {
+        RBTreeNodeBase *x, *x_parent;
+        RBTree_color removed_color;
+        if (target->left == nullptr || target->right == nullptr) {
+            x = target->left != nullptr ? target->left : target->right;
+            x_parent = target->parent;
+            removed_color = target->color;
+            *target->p_parent = x;
+            if (x != nullptr) {
+                x->parent = target->parent;
+                x->p_parent = target->p_parent;
+            }
+        } else {
+            RBTreeNodeBase* successor = target->right;
+            while (successor->left != nullptr) {
+                successor = successor->left;
+            }
+            removed_color = successor->color;
+            x = successor->right;
+            if (successor->parent == target) {
+                x_parent = successor;
+            } else {
+                // 后继节点没有左子节点, 用它的右子节点顶替它原来的位置
+                x_parent = successor->parent;
+                *successor->p_parent = x;
+                if (x != nullptr) {
+                    x->parent = successor->parent;
+                    x->p_parent = successor->p_parent;
+                }
+                successor->right = target->right;
+                successor->right->parent = successor;
+                successor->right->p_parent = &successor->right;
+            }
+            *target->p_parent = successor;
+            successor->parent = target->parent;
+            successor->p_parent = target->p_parent;
+            successor->left = target->left;
+            successor->left->parent = successor;
+            successor->left->p_parent = &successor->left;
+            successor->color = target->color;
+        }
+        if (removed_color == BLACK) TreeBase::M_erase_fixup(x, x_parent);
+        m_block->m_size -= 1;
+    }
+
+    /**
+     * 删除节点, 节点回到池的空闲链表中供之后的插入复用
+     */
+    void M_erase_node(RBTreeNodeBase* target) noexcept {
+        M_unlink(target);
+        M_destroy_node(target);
+    }
+
+    /**
+     * 删除pos, 返回下一个位置
+     */
+    iterator M_erase(const_iterator pos) noexcept {
+        RBTreeNodeBase* target = pos.node;
+        ++pos;
+        M_erase_node(target);
+        return M_unconst(pos);
+    }
+
+    /**
+     * 删除[first, last), 返回last
+     */
+    iterator M_erase(const_iterator first, const_iterator last) noexcept {
+        if (first == begin() && last == end()) {
+            M_clear();
+            return end();
+        }
+        while (first != last) {
+            RBTreeNodeBase* target = first.node;
+            ++first;
+            M_erase_node(target);
+        }
+        return M_unconst(last);
+    }
 
-        return nullptr;
+    /**
+     * 析构所有元素, 节点全部回到空闲链表, 不归还chunk
+     */
+    void M_clear() noexcept {
+        M_recycle_subtree(m_block->m_node);
+        m_block->m_node = nullptr;
+        m_block->m_size = 0;
     }
 
-    iterator M_multi_insert(int val) {
-        RBTreeNode** p_parent = &m_block->m_node;
-        RBTreeNode* parent = nullptr;
+    void M_recycle_subtree(RBTreeNodeBase* node) noexcept {
+        while (node != nullptr) {
+            M_recycle_subtree(node->left);
+            RBTreeNodeBase* right = node->right;
+            M_destroy_node(node);
+            node = right;
+        }
+    }
+
+    /**
+     * 查找key应当插入的位置; 已有相同值时返回该节点, 否则返回nullptr
+     */
+    template<class K>
+    RBTreeNodeBase* M_insert_pos(K const& key, RBTreeNodeBase*& parent, RBTreeNodeBase**& p_parent) const {
+        p_parent = &m_block->m_node;
+        parent = nullptr;
         while (*p_parent != nullptr) {
             parent = *p_parent;
-            if (parent->val < val) {
+            if (m_comp(S_val(parent), key)) {
                 p_parent = &parent->right;
                 continue;
-            } else if (parent->val > val) {
+            } else if (m_comp(key, S_val(parent))) {
                 p_parent  = &parent->left;
                 continue;
             }
+            return parent; // 找到了相同值的节点
         }
-        auto* new_node = new RBTreeNode;
-        new_node->val = val;
-        new_node->right = nullptr;
-        new_node->left = nullptr;
-        new_node->color = RED;
-
-        new_node->parent = parent;
-        new_node->p_parent = p_parent;
-        *p_parent = new_node;
-        TreeBase::M_fix_violation(new_node);
+        return nullptr;
+    }
 
+    /**
+     * 先按值查找, 不存在时才构造节点, 重复插入不分配内存
+     * @param val T const&或T&&
+     * @return 插入的节点或已有的节点, 以及是否插入
+     */
+    template<class V>
+    std::pair<RBTreeNodeBase*, bool> M_single_insert(V&& val) {
+        RBTreeNodeBase *parent, **p_parent;
+        if (RBTreeNodeBase* found = M_insert_pos(val, parent, p_parent)) {
+            return {found, false};
+        }
+        Node* new_node = M_create_node(std::forward<V>(val));
+        M_link(new_node, parent, p_parent);
+        return {new_node, true};
+    }
+
+    /**
+     * 先构造节点才能得到键, 已有相同值时销毁新节点
+     */
+    template<class ...Args>
+    std::pair<RBTreeNodeBase*, bool> M_single_emplace(Args &&... args) {
+        Node* new_node = M_create_node(std::forward<Args>(args)...);
+        RBTreeNodeBase *parent, **p_parent;
+        RBTreeNodeBase* found;
+        try {
+            found = M_insert_pos(new_node->val, parent, p_parent);
+        } catch (...) {
+            M_destroy_node(new_node);
+            throw;
+        }
+        if (found != nullptr) {
+            M_destroy_node(new_node);
+            return {found, false};
+        }
+        M_link(new_node, parent, p_parent);
+        return {new_node, true};
+    }
+
+    /**
+     * 插入到所有相同值之后, 相同值按插入顺序排列
+     */
+    template<class ...Args>
+    RBTreeNodeBase* M_multi_insert(Args &&... args) {
+        Node* new_node = M_create_node(std::forward<Args>(args)...);
+        RBTreeNodeBase** p_parent = &m_block->m_node;
+        RBTreeNodeBase* parent = nullptr;
+        try {
+            while (*p_parent != nullptr) {
+                parent = *p_parent;
+                if (m_comp(new_node->val, S_val(parent))) {
+                    p_parent = &parent->left;
+                } else {
+                    p_parent = &parent->right;
+                }
+            }
+        } catch (...) {
+            M_destroy_node(new_node);
+            throw;
+        }
+        M_link(new_node, parent, p_parent);
         return new_node;
     }
 
-public:
-
-    T *operator->() const noexcept {
-        return &this->m_block->m_node->val;
+    /**
+     * 按比较器检查[first, last)是否有序; strict为true时还要求没有相同的值
+     * 只接受值类型为T的输入: 其他类型转换成T之后可能出现重复或者顺序改变(例如double截断成int)
+     */
+    template<std::forward_iterator It> requires std::same_as<std::iter_value_t<It>, T>
+    [[nodiscard]] bool M_is_sorted(It first, It last, bool strict) const {
+        if (first == last) return true;
+        for (It next = std::next(first); next != last; first = next, ++next) {
+            if (strict ? !m_comp(*first, *next) : m_comp(*next, *first)) return false;
+        }
+        return true;
+    }
+
+    /**
+     * 由有序的[first, first + n)直接建出平衡的红黑树, O(n), 要求树为空
+     * 有序指的是逐个转换成T之后按比较器有序
+     * 节点来自同一块连续内存, 中序遍历的顺序就是内存顺序
+     * 按中点递归划分时所有空指针的深度只差一层, 把最深一层染红即满足红黑树的性质
+     */
+    template<std::forward_iterator It>
+    void M_build_sorted(It first, size_t n) {
+        assert(m_block->m_node == nullptr);
+        if (n == 0) return;
+        Node* nodes = m_pool.allocate_bulk(n);
+        size_t built = 0;
+        try {
+            for (; built < n; built++, ++first) {
+                ::new (static_cast<void *>(nodes + built)) Node{{nullptr, nullptr, nullptr, nullptr, BLACK}, T(*first)};
+            }
+        } catch (...) {
+            for (size_t i = 0; i < n; i++) {
+                if (i < built) std::destroy_at(nodes + i);
+                m_pool.deallocate(nodes + i);
+            }
+            throw;
+        }
+        size_t red_depth = std::bit_width(n) - 1;
+        S_build(nodes, 0, n, nullptr, &m_block->m_node, 0, red_depth);
+        m_block->m_size = n;
     }
 
-    T operator*() const noexcept {
-        return this->m_block->m_node->val;
+    static void S_build(Node* nodes, size_t lo, size_t hi, RBTreeNodeBase* parent, RBTreeNodeBase** p_parent,
+                        size_t depth, size_t red_depth) noexcept {
+        if (lo == hi) {
+            *p_parent = nullptr;
+            return;
+        }
+        size_t mid = lo + (hi - lo) / 2;
+        Node* node = nodes + mid;
+        node->parent = parent;
+        node->p_parent = p_parent;
+        node->color = depth == red_depth && depth > 0 ? RED : BLACK;
+        *p_parent = node;
+        S_build(nodes, lo, mid, node, &node->left, depth + 1, red_depth);
+        S_build(nodes, mid + 1, hi, node, &node->right, depth + 1, red_depth);
+    }
+
+    /**
+     * 检查红黑树的性质, 返回黑高; 仅用于测试
+     */
+    size_t M_verify() const {
+        size_t count = 0;
+        size_t height = M_verify_subtree(m_block->m_node, nullptr, &m_block->m_node, count);
+        assert(m_block->m_node == nullptr || m_block->m_node->color == BLACK);
+        assert(count == m_block->m_size);
+        return height;
+    }
+
+    iterator M_iter(RBTreeNodeBase* node) const noexcept {
+        if (node == nullptr) return iterator(&m_block->m_node);
+        return iterator(node);
+    }
+
+    iterator M_unconst(const_iterator it) const noexcept {
+        return M_iter(it.off_by_one ? nullptr : it.node);
+    }
+
+private:
+    size_t M_verify_subtree(RBTreeNodeBase const* node, RBTreeNodeBase const* parent, RBTreeNodeBase* const* p_parent,
+                    size_t& count) const {
+        if (node == nullptr) return 1;
+        assert(node->parent == parent && node->p_parent == p_parent);
+        assert(node->color == BLACK || node->left == nullptr || node->left->color == BLACK);
+        assert(node->color == BLACK || node->right == nullptr || node->right->color == BLACK);
+        assert(node->left == nullptr || !m_comp(S_val(node), S_val(node->left)));
+        assert(node->right == nullptr || !m_comp(S_val(node->right), S_val(node)));
+        count += 1;
+        size_t left = M_verify_subtree(node->left, node, &node->left, count);
+        size_t right = M_verify_subtree(node->right, node, &node->right, count);
+        assert(left == right);
+        return left + (node->color == BLACK ? 1 : 0);
     }
 
-
+public:
     iterator begin() noexcept {
-        return Min_Node();
+        return M_iter(Min_Node());
     }
 
-    reverse_iterator rbegin() noexcept {
-        return Max_Node();
+    const_iterator begin() const noexcept {
+        return M_iter(Min_Node());
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
     }
 
     iterator end() noexcept {
-        return {Max_Node(), true};
+        return iterator(&m_block->m_node);
     }
 
-    reverse_iterator rend() noexcept {
-        return {Min_Node(), true};
+    const_iterator end() const noexcept {
+        return iterator(&m_block->m_node);
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    reverse_iterator rbegin() noexcept {
+        RBTreeNodeBase* node = Max_Node();
+        if (node == nullptr) return rend();
+        return reverse_iterator(node);
     }
 
-    iterator _M_find(int val) noexcept {
-        RBTreeNode *res = M_find(val);
-        if (res) return m_block->m_node;
-        else return end();
+    const_reverse_iterator rbegin() const noexcept {
+        RBTreeNodeBase* node = Max_Node();
+        if (node == nullptr) return rend();
+        return reverse_iterator(node);
     }
 
-    const_iterator _M_find(int val) const noexcept {
-        RBTreeNode *res = M_find(val);
-        if (res) return m_block->m_node;
-        else return end();
+    reverse_iterator rend() noexcept {
+        return reverse_iterator(&m_block->m_node);
     }
 
-    std::pair<iterator, bool> single_insert(int val) {
-        return {M_single_insert(val), true};
+    const_reverse_iterator rend() const noexcept {
+        return reverse_iterator(&m_block->m_node);
     }
 
-    iterator multi_insert(int val) {
-        return M_multi_insert(val);
+    [[nodiscard]] size_t size() const noexcept {
+        return m_block->m_size;
     }
 
-    size_t count(int val) const noexcept {
-        return M_find(val) != nullptr ? 0 : 1;
+    [[nodiscard]] bool empty() const noexcept {
+        return m_block->m_size == 0;
     }
 
-    size_t contains(int val) const noexcept {
-        return M_find(val) != nullptr;
+    [[nodiscard]] Compare key_comp() const {
+        return m_comp;
     }
 
+    [[nodiscard]] Alloc get_allocator() const {
+        return m_pool.get_allocator();
+    }
 };
 
 template<class T>
 struct TreeImpl : protected TreeBase<T> {
 
-};
\ No newline at end of file
+};
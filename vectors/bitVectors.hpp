@@ -0,0 +1,304 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+
+#include "vectors.hpp"
+#include "kernels.hpp"
+
+/**
+ * 按位存储的bool向量, 每个64位字存放64个标志, 内存和带宽都是@code{Vectors<bool>}的1/8
+ * 最后一个字中超出size()的位始终为0, 因此count()和位运算不需要特殊处理结尾
+ * count/and/or/xor/andnot按字进行, 通过@code{kernels}选择AVX-512/AVX2实现
+ * 没有特化@code{Vectors<bool>}: 它的data()返回bool*, 已有代码可能依赖这一点
+ */
+class BitVectors {
+private:
+    using Words = Vectors<uint64_t>;
+    static constexpr size_t kAlign = Words::alignment;
+
+    Words m_words;
+    size_t m_size;
+
+public:
+    /** find_first/find_next找不到时的返回值 */
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /**
+     * 指向某一位的代理引用
+     */
+    class reference {
+    private:
+        uint64_t* m_word;
+        uint64_t m_mask;
+
+    public:
+        reference(uint64_t* word, uint64_t mask) noexcept : m_word(word), m_mask(mask) {};
+
+        operator bool() const noexcept {
+            return (*m_word & m_mask) != 0;
+        }
+
+        reference& operator=(bool val) noexcept {
+            if (val) {
+                *m_word |= m_mask;
+            } else {
+                *m_word &= ~m_mask;
+            }
+            return *this;
+        }
+
+        reference& operator=(reference const& that) noexcept {
+            return *this = static_cast<bool>(that);
+        }
+
+        void flip() noexcept {
+            *m_word ^= m_mask;
+        }
+    };
+
+    BitVectors() noexcept : m_size(0) {};
+
+    explicit BitVectors(size_t n, bool val = false) : m_words(S_words(n), val ? ~uint64_t(0) : 0), m_size(n) {
+        M_clear_tail();
+    }
+
+    BitVectors(std::initializer_list<bool> list) : m_size(0) {
+        reserve(list.size());
+        for (bool b: list) {
+            push_back(b);
+        }
+    }
+
+    void push_back(bool val) {
+        if (m_size % 64 == 0) m_words.push_back(0);
+        m_size += 1;
+        if (val) set(m_size - 1);
+    }
+
+    void pop_back() {
+        m_size -= 1;
+        reset(m_size);
+        if (m_size % 64 == 0) m_words.pop_back();
+    }
+
+    /**
+     * 新增的位为val
+     * @param n
+     * @param val
+     */
+    void resize(size_t n, bool val = false) {
+        size_t old = m_size;
+        if (n > old && val && old % 64 != 0) {
+            m_words[old / 64] |= ~uint64_t(0) << (old % 64);
+        }
+        m_words.resize(S_words(n), val ? ~uint64_t(0) : 0);
+        m_size = n;
+        M_clear_tail();
+    }
+
+    void reserve(size_t n) {
+        m_words.reserve(S_words(n));
+    }
+
+    void clear() {
+        m_words.clear();
+        m_size = 0;
+    }
+
+    [[nodiscard]] bool operator[](size_t i) const noexcept {
+        return (m_words[i / 64] >> (i % 64)) & 1;
+    }
+
+    reference operator[](size_t i) noexcept {
+        return {&m_words[i / 64], uint64_t(1) << (i % 64)};
+    }
+
+    [[nodiscard]] bool at(size_t i) const {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return (*this)[i];
+    }
+
+    reference at(size_t i) {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return (*this)[i];
+    }
+
+    [[nodiscard]] bool test(size_t i) const noexcept {
+        return (*this)[i];
+    }
+
+    void set(size_t i, bool val = true) noexcept {
+        (*this)[i] = val;
+    }
+
+    void reset(size_t i) noexcept {
+        m_words[i / 64] &= ~(uint64_t(1) << (i % 64));
+    }
+
+    void flip(size_t i) noexcept {
+        m_words[i / 64] ^= uint64_t(1) << (i % 64);
+    }
+
+    /**
+     * 所有位置1
+     */
+    void set() noexcept {
+        std::fill(m_words.begin(), m_words.end(), ~uint64_t(0));
+        M_clear_tail();
+    }
+
+    /**
+     * 所有位置0
+     */
+    void reset() noexcept {
+        std::fill(m_words.begin(), m_words.end(), 0);
+    }
+
+    /**
+     * 1的个数
+     * @return
+     */
+    [[nodiscard]] size_t count() const noexcept {
+        return kernels::popcount<kAlign>(m_words.data(), m_words.size());
+    }
+
+    [[nodiscard]] bool any() const noexcept {
+        return find_first() != npos;
+    }
+
+    [[nodiscard]] bool none() const noexcept {
+        return !any();
+    }
+
+    [[nodiscard]] bool all() const noexcept {
+        return count() == m_size;
+    }
+
+    /**
+     * 第一个1的下标, 没有时返回npos
+     * @return
+     */
+    [[nodiscard]] size_t find_first() const noexcept {
+        return M_scan(0, m_words.size() == 0 ? 0 : m_words[0]);
+    }
+
+    /**
+     * pos之后(不含pos)第一个1的下标, 没有时返回npos
+     * 例如: @code{for (size_t i = bits.find_first(); i != BitVectors::npos; i = bits.find_next(i))}
+     * @param pos
+     * @return
+     */
+    [[nodiscard]] size_t find_next(size_t pos) const noexcept {
+        pos += 1;
+        if (pos >= m_size) return npos;
+        size_t w = pos / 64;
+        return M_scan(w, m_words[w] & (~uint64_t(0) << (pos % 64)));
+    }
+
+    /* 两个位图的长度必须相同, 否则抛出std::invalid_argument */
+
+    BitVectors& operator&=(BitVectors const& that) {
+        return M_apply(that, kernels::BitAnd{});
+    }
+
+    BitVectors& operator|=(BitVectors const& that) {
+        return M_apply(that, kernels::BitOr{});
+    }
+
+    BitVectors& operator^=(BitVectors const& that) {
+        return M_apply(that, kernels::BitXor{});
+    }
+
+    /**
+     * *this &= ~that
+     */
+    BitVectors& andnot(BitVectors const& that) {
+        return M_apply(that, kernels::BitAndNot{});
+    }
+
+    /**
+     * (*this & that).count(), 不需要生成中间的位图
+     */
+    [[nodiscard]] size_t count_and(BitVectors const& that) const {
+        M_check_size(that);
+        return kernels::popcount_and<kAlign>(m_words.data(), that.m_words.data(), m_words.size());
+    }
+
+    friend BitVectors operator&(BitVectors lhs, BitVectors const& rhs) {
+        return std::move(lhs &= rhs);
+    }
+
+    friend BitVectors operator|(BitVectors lhs, BitVectors const& rhs) {
+        return std::move(lhs |= rhs);
+    }
+
+    friend BitVectors operator^(BitVectors lhs, BitVectors const& rhs) {
+        return std::move(lhs ^= rhs);
+    }
+
+    bool operator==(BitVectors const& that) const noexcept {
+        return m_size == that.m_size && std::equal(m_words.cbegin(), m_words.cend(), that.m_words.cbegin());
+    }
+
+    /**
+     * 底层的64位字, 第i位在words()[i / 64]的第(i % 64)位
+     * @return
+     */
+    [[nodiscard]] std::span<uint64_t const> words() const noexcept {
+        return {m_words.data(), m_words.size()};
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_size;
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept {
+        return m_words.capacity() * 64;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+private:
+    static size_t S_words(size_t bits) noexcept {
+        return (bits + 63) / 64;
+    }
+
+    /**
+     * 把最后一个字中超出size()的位清零
+     */
+    void M_clear_tail() noexcept {
+        if (m_size % 64 != 0) m_words[m_size / 64] &= (uint64_t(1) << (m_size % 64)) - 1;
+    }
+
+    /**
+     * 从第w个字开始找第一个非0的字, 第w个字使用已经屏蔽过的值word
+     */
+    [[nodiscard]] size_t M_scan(size_t w, uint64_t word) const noexcept {
+        size_t n = m_words.size();
+        while (word == 0) {
+            if (++w >= n) return npos;
+            word = m_words[w];
+        }
+        return w * 64 + std::countr_zero(word);
+    }
+
+    void M_check_size(BitVectors const& that) const {
+        if (m_size != that.m_size) throw std::invalid_argument("BitVectors: size mismatch");
+    }
+
+    template<class Op>
+    BitVectors& M_apply(BitVectors const& that, Op op) {
+        M_check_size(that);
+        kernels::bitwise<Op, kAlign>(m_words.data(), that.m_words.data(), m_words.size(), op);
+        return *this;
+    }
+};
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cassert>
+#include <random>
+#include <iostream>
+
+#include "bitVectors.hpp"
+
+int main() {
+    /* 基本操作与代理引用 */
+    {
+        BitVectors bits = {true, false, true};
+        bits.push_back(true);
+        bits[1] = bits[0];
+        bits[0].flip();
+        assert(bits.size() == 4 && !bits[0] && bits[1] && bits.at(3));
+        assert(bits.count() == 3 && bits.find_first() == 1 && bits.find_next(1) == 2);
+        bits.pop_back();
+        assert(bits.count() == 2 && bits.find_next(2) == BitVectors::npos);
+
+        bits.resize(130, true);
+        assert(bits.size() == 130 && bits.count() == 129 && bits.words().size() == 3);
+        bits.resize(65);
+        assert(bits.count() == 64 && bits.words()[1] == 1);
+        bits.reset();
+        assert(bits.none() && bits.find_first() == BitVectors::npos);
+        bits.set();
+        assert(bits.all() && bits.count() == 65);
+
+        bool thrown = false;
+        try {
+            bits.at(65);
+        } catch (std::out_of_range const&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 位运算与逐位计算的结果一致 */
+    {
+        constexpr size_t n = 100003;
+        std::mt19937_64 rng(42);
+        BitVectors a(n), b(n);
+        Vectors<bool> ref_a(n), ref_b(n);
+        for (size_t i = 0; i < n; i++) {
+            bool x = rng() % 3 == 0, y = rng() % 2 == 0;
+            a[i] = x;
+            b[i] = y;
+            ref_a[i] = x;
+            ref_b[i] = y;
+        }
+        size_t both = 0, either = 0, diff = 0, only_a = 0;
+        for (size_t i = 0; i < n; i++) {
+            both += ref_a[i] && ref_b[i];
+            either += ref_a[i] || ref_b[i];
+            diff += ref_a[i] != ref_b[i];
+            only_a += ref_a[i] && !ref_b[i];
+        }
+        assert((a & b).count() == both && a.count_and(b) == both);
+        assert((a | b).count() == either && (a ^ b).count() == diff);
+        BitVectors c = a;
+        c.andnot(b);
+        assert(c.count() == only_a);
+
+        size_t visited = 0;
+        for (size_t i = c.find_first(); i != BitVectors::npos; i = c.find_next(i)) {
+            assert(ref_a[i] && !ref_b[i]);
+            visited++;
+        }
+        assert(visited == only_a);
+        std::cout << "and: " << both << " or: " << either << " xor: " << diff << " andnot: " << only_a << std::endl;
+
+        bool thrown = false;
+        try {
+            a &= BitVectors(n + 1);
+        } catch (std::invalid_argument const&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 大位图求交集并计数 */
+    {
+        constexpr size_t n = size_t(1) << 28;
+        BitVectors a(n, true), b(n);
+        for (size_t i = 0; i < n; i += 3) {
+            b[i] = true;
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        a &= b;
+        size_t c = a.count();
+        auto end = std::chrono::high_resolution_clock::now();
+        assert(c == (n + 2) / 3);
+        std::cout << "intersect + count of " << n << " bits: "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms ("
+                  << kernels::isa_name(kernels::active_isa()) << ")" << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+    return 0;
+}
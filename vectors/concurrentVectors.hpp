@@ -0,0 +1,293 @@
+#pragma once
+
+#include <new>
+#include <bit>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vectors.hpp"
+
+/**
+ * 多个线程可以同时追加的向量, 只能追加, 不能删除单个元素
+ * 存储分为若干段, 第k段有kFirstSegment << k个元素, 已有的段不会搬迁, 元素的地址和引用一直有效
+ * 1. 追加: fetch_add领取下标, 所在的段不存在时由领取到的线程分配并用CAS安装, 构造完成后置位该位置的发布标志;
+ *    全程没有锁, 线程之间只在计数器上竞争, 需要更高吞吐时使用@code{Appender}一次领取一批下标
+ * 2. 读取: 已经发布的下标可以与追加并发地读取; at(i)检查发布标志, operator[]由调用者保证i已经发布
+ * 3. freeze(): 没有并发追加时, 把所有元素按下标顺序搬到一个连续的@code{Vectors<T>}中并清空自己
+ * @tparam T
+ */
+template<class T>
+class ConcurrentVectors {
+public:
+    static constexpr size_t kFirstSegment = 64;
+
+private:
+    static constexpr int kFirstShift = std::countr_zero(kFirstSegment);
+    static constexpr size_t kMaxSegments = 64 - kFirstShift;
+
+    /** 每个位置的状态: 还没有构造/已经发布/构造时抛出异常, 永远不会发布 */
+    enum : unsigned char { kEmpty = 0, kReady = 1, kAbandoned = 2 };
+
+    std::atomic<size_t> m_claimed;
+    std::atomic<T*> m_segments[kMaxSegments];
+
+public:
+    ConcurrentVectors() noexcept : m_claimed(0), m_segments{} {};
+
+    ConcurrentVectors(ConcurrentVectors const&) = delete;
+    ConcurrentVectors& operator=(ConcurrentVectors const&) = delete;
+
+    ~ConcurrentVectors() {
+        M_release();
+    }
+
+    /**
+     * 批量领取下标的追加器, 每个线程持有一个
+     * 每batch个元素才访问一次共享计数器, 同一线程的元素相邻, 也避免了与其他线程的伪共享
+     * 析构时没有用完的下标被标记为放弃, freeze()时跳过
+     */
+    class Appender {
+    private:
+        ConcurrentVectors& m_owner;
+        size_t m_batch;
+        size_t m_next;
+        size_t m_end;
+
+    public:
+        explicit Appender(ConcurrentVectors& owner, size_t batch = 64) noexcept
+        : m_owner(owner), m_batch(batch == 0 ? 1 : batch), m_next(0), m_end(0) {};
+
+        Appender(Appender const&) = delete;
+        Appender& operator=(Appender const&) = delete;
+
+        ~Appender() {
+            for (; m_next < m_end; m_next++) {
+                m_owner.M_abandon(m_next);
+            }
+        }
+
+        size_t push_back(T const& val) {
+            return emplace_back(val);
+        }
+
+        size_t push_back(T&& val) {
+            return emplace_back(std::move(val));
+        }
+
+        /**
+         * @return 新元素的下标
+         */
+        template<class ...Args>
+        size_t emplace_back(Args &&... args) {
+            if (m_next == m_end) [[unlikely]] {
+                m_next = m_owner.m_claimed.fetch_add(m_batch, std::memory_order_relaxed);
+                m_end = m_next + m_batch;
+            }
+            size_t i = m_next++;
+            m_owner.M_construct(i, std::forward<Args>(args)...);
+            return i;
+        }
+    };
+
+    /**
+     * @return 新元素的下标
+     */
+    size_t push_back(T const& val) {
+        size_t i = m_claimed.fetch_add(1, std::memory_order_relaxed);
+        M_construct(i, val);
+        return i;
+    }
+
+    size_t push_back(T&& val) {
+        size_t i = m_claimed.fetch_add(1, std::memory_order_relaxed);
+        M_construct(i, std::move(val));
+        return i;
+    }
+
+    template<class ...Args>
+    T& emplace_back(Args &&... args) {
+        size_t i = m_claimed.fetch_add(1, std::memory_order_relaxed);
+        return M_construct(i, std::forward<Args>(args)...);
+    }
+
+    /**
+     * 已经领取的下标个数, 其中可能有还没有发布的位置
+     * @return
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        return m_claimed.load(std::memory_order_acquire);
+    }
+
+    /**
+     * 下标i的元素是否已经构造完成并且对当前线程可见
+     * @param i
+     * @return
+     */
+    [[nodiscard]] bool is_published(size_t i) const noexcept {
+        if (i >= size()) return false;
+        auto [k, off] = S_locate(i);
+        T* base = m_segments[k].load(std::memory_order_acquire);
+        return base != nullptr && S_state(base, k)[off].load(std::memory_order_acquire) == kReady;
+    }
+
+    /**
+     * 调用者需要保证下标i已经发布, 例如i是push_back的返回值, 或者is_published(i)返回过true
+     */
+    T& operator[](size_t i) noexcept {
+        auto [k, off] = S_locate(i);
+        return m_segments[k].load(std::memory_order_acquire)[off];
+    }
+
+    T const& operator[](size_t i) const noexcept {
+        auto [k, off] = S_locate(i);
+        return m_segments[k].load(std::memory_order_acquire)[off];
+    }
+
+    [[nodiscard]] T const& at(size_t i) const {
+        if (!is_published(i)) throw std::out_of_range("vector::at");
+        return (*this)[i];
+    }
+
+    T& at(size_t i) {
+        if (!is_published(i)) throw std::out_of_range("vector::at");
+        return (*this)[i];
+    }
+
+    /**
+     * 按下标顺序把所有已经发布的元素搬到一个连续的向量中, 之后当前对象为空
+     * 调用时不能有其他线程正在追加
+     * @return
+     */
+    Vectors<T> freeze() {
+        size_t n = m_claimed.load(std::memory_order_acquire);
+        Vectors<T> res;
+        res.reserve(n);
+        for (size_t k = 0; k < kMaxSegments && S_segment_begin(k) < n; k++) {
+            T* base = m_segments[k].load(std::memory_order_acquire);
+            if (base == nullptr) continue;
+            size_t count = std::min(S_segment_size(k), n - S_segment_begin(k));
+            auto state = S_state(base, k);
+            if constexpr (is_trivially_relocatable_v<T> && std::is_trivially_default_constructible_v<T>) {
+                bool all_ready = true;
+                for (size_t j = 0; j < count; j++) {
+                    all_ready &= state[j].load(std::memory_order_relaxed) == kReady;
+                }
+                if (all_ready) {
+                    // 整段按字节搬迁, 旧的位置之后只释放内存
+                    uninitialized_relocate_n(base, count, res.append_uninitialized(count).data());
+                    for (size_t j = 0; j < count; j++) {
+                        state[j].store(kEmpty, std::memory_order_relaxed);
+                    }
+                    continue;
+                }
+            }
+            for (size_t j = 0; j < count; j++) {
+                if (state[j].load(std::memory_order_relaxed) != kReady) continue;
+                res.emplace_back(std::move(base[j]));
+            }
+        }
+        M_release();
+        return res;
+    }
+
+private:
+    struct Location {
+        size_t segment;
+        size_t offset;
+    };
+
+    static Location S_locate(size_t i) noexcept {
+        size_t biased = i + kFirstSegment;
+        size_t k = std::bit_width(biased) - 1 - kFirstShift;
+        return {k, biased - (kFirstSegment << k)};
+    }
+
+    static size_t S_segment_size(size_t k) noexcept {
+        return kFirstSegment << k;
+    }
+
+    static size_t S_segment_begin(size_t k) noexcept {
+        return (kFirstSegment << k) - kFirstSegment;
+    }
+
+    /** 每一段是一块连续的内存: 前面是元素, 后面紧跟着每个元素一个字节的状态 */
+    static std::atomic<unsigned char>* S_state(T* base, size_t k) noexcept {
+        return reinterpret_cast<std::atomic<unsigned char> *>(reinterpret_cast<unsigned char *>(base + S_segment_size(k)));
+    }
+
+    static size_t S_segment_bytes(size_t k) noexcept {
+        return S_segment_size(k) * (sizeof(T) + 1);
+    }
+
+    /**
+     * 返回第k段, 不存在时分配并安装; 多个线程同时安装时只有一个成功, 其他线程释放自己分配的内存
+     * @param k
+     * @return
+     */
+    T* M_segment(size_t k) {
+        T* base = m_segments[k].load(std::memory_order_acquire);
+        if (base != nullptr) [[likely]] return base;
+
+        void* raw = ::operator new(S_segment_bytes(k), std::align_val_t(alignof(T)));
+        auto fresh = static_cast<T *>(raw);
+        auto state = S_state(fresh, k);
+        for (size_t j = 0; j < S_segment_size(k); j++) {
+            new(&state[j]) std::atomic<unsigned char>(kEmpty);
+        }
+        if (m_segments[k].compare_exchange_strong(base, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return fresh;
+        }
+        ::operator delete(raw, S_segment_bytes(k), std::align_val_t(alignof(T)));
+        return base;
+    }
+
+    template<class ...Args>
+    T& M_construct(size_t i, Args &&... args) {
+        auto [k, off] = S_locate(i);
+        // 分配失败时这个下标永远不会发布, 以后安装这一段的线程会把它初始化为kEmpty, freeze()时跳过
+        T* base = M_segment(k);
+        auto state = S_state(base, k);
+        try {
+            std::construct_at(&base[off], std::forward<Args>(args)...);
+        } catch (...) {
+            state[off].store(kAbandoned, std::memory_order_release);
+            throw;
+        }
+        state[off].store(kReady, std::memory_order_release);
+        return base[off];
+    }
+
+    /**
+     * 在Appender的析构函数中调用, 不能分配内存: 所在的段还不存在时什么都不做,
+     * 以后安装这一段时这个位置被初始化为kEmpty, 同样不会发布
+     */
+    void M_abandon(size_t i) noexcept {
+        auto [k, off] = S_locate(i);
+        T* base = m_segments[k].load(std::memory_order_acquire);
+        if (base == nullptr) return;
+        S_state(base, k)[off].store(kAbandoned, std::memory_order_release);
+    }
+
+    /**
+     * 析构所有已经发布的元素并释放所有段
+     */
+    void M_release() noexcept {
+        for (size_t k = 0; k < kMaxSegments; k++) {
+            T* base = m_segments[k].exchange(nullptr, std::memory_order_acq_rel);
+            if (base == nullptr) continue;
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                auto state = S_state(base, k);
+                for (size_t j = 0; j < S_segment_size(k); j++) {
+                    if (state[j].load(std::memory_order_relaxed) == kReady) std::destroy_at(&base[j]);
+                }
+            }
+            ::operator delete(base, S_segment_bytes(k), std::align_val_t(alignof(T)));
+        }
+        m_claimed.store(0, std::memory_order_release);
+    }
+};
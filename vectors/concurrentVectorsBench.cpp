@@ -0,0 +1,49 @@
+#include <chrono>
+#include <thread>
+#include <string>
+#include <iostream>
+
+#include "concurrentVectors.hpp"
+
+/**
+ * threads个线程各追加per_thread个元素, 返回每秒追加的百万元素数
+ */
+template<bool Batched>
+double append_throughput(size_t threads, size_t per_thread) {
+    ConcurrentVectors<uint64_t> vec;
+    Vectors<std::thread> workers;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&vec, t, per_thread] {
+            if constexpr (Batched) {
+                ConcurrentVectors<uint64_t>::Appender out(vec, 256);
+                for (size_t i = 0; i < per_thread; i++) {
+                    out.push_back(t * per_thread + i);
+                }
+            } else {
+                for (size_t i = 0; i < per_thread; i++) {
+                    vec.push_back(t * per_thread + i);
+                }
+            }
+        });
+    }
+    for (auto& w: workers) {
+        w.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return threads * per_thread / std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    size_t total = argc > 1 ? std::stoull(argv[1]) : size_t(1) << 22;
+    size_t max_threads = argc > 2 ? std::stoull(argv[2]) : 32;
+    /* 追加吞吐量(百万元素/秒) */
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << " elements: " << total << std::endl;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        size_t per_thread = total / threads;
+        std::cout << "threads: " << threads
+                  << " push_back: " << append_throughput<false>(threads, per_thread)
+                  << " Appender: " << append_throughput<true>(threads, per_thread) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <thread>
+#include <cassert>
+#include <algorithm>
+#include <string>
+#include <iostream>
+
+#include "concurrentVectors.hpp"
+
+int main() {
+    /* 并发追加, 同时另一个线程读取已经发布的元素 */
+    {
+        ConcurrentVectors<std::string> names;
+        std::atomic<bool> done{false};
+        std::thread reader([&] {
+            size_t seen = 0;
+            while (!done.load()) {
+                size_t n = names.size();
+                for (size_t i = 0; i < n; i++) {
+                    if (names.is_published(i)) seen += names[i].size() != 0;
+                }
+            }
+            std::cout << "reader saw " << seen << " published elements" << std::endl;
+        });
+        Vectors<std::thread> writers;
+        for (int t = 0; t < 4; t++) {
+            writers.emplace_back([&names, t] {
+                for (int i = 0; i < 2000; i++) {
+                    std::string& s = names.emplace_back(std::to_string(t * 10000 + i));
+                    assert(!s.empty());
+                }
+            });
+        }
+        for (auto& w: writers) {
+            w.join();
+        }
+        done.store(true);
+        reader.join();
+
+        assert(names.size() == 8000);
+        std::string const* first = &names[0];
+        names.push_back("last");
+        assert(&names[0] == first && names.at(8000) == "last");
+
+        Vectors<std::string> frozen = names.freeze();
+        assert(frozen.size() == 8001 && names.size() == 0 && frozen[8000] == "last");
+        std::cout << "frozen: " << frozen.size() << " strings" << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* Appender没有用完的下标在freeze()时被跳过 */
+    {
+        ConcurrentVectors<int> ints;
+        {
+            ConcurrentVectors<int>::Appender out(ints, 100);
+            for (int i = 0; i < 150; i++) {
+                out.push_back(i);
+            }
+        }
+        ints.push_back(-1);
+        assert(ints.size() == 201 && !ints.is_published(199) && ints.at(200) == -1);
+        Vectors<int> frozen = ints.freeze();
+        assert(frozen.size() == 151 && frozen[149] == 149 && frozen[150] == -1);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 多个线程通过Appender批量追加, 每个值恰好出现一次 */
+    {
+        constexpr int kThreads = 4, kPerThread = 1000;
+        ConcurrentVectors<int> ints;
+        Vectors<std::thread> writers;
+        for (int t = 0; t < kThreads; t++) {
+            writers.emplace_back([&ints, t] {
+                ConcurrentVectors<int>::Appender out(ints, 64);
+                for (int i = 0; i < kPerThread; i++) {
+                    out.push_back(t * kPerThread + i);
+                }
+            });
+        }
+        for (auto& w: writers) {
+            w.join();
+        }
+        Vectors<int> frozen = ints.freeze();
+        assert(frozen.size() == kThreads * kPerThread);
+        std::sort(frozen.begin(), frozen.end());
+        for (int i = 0; i < kThreads * kPerThread; i++) {
+            assert(frozen[i] == i);
+        }
+        std::cout << "appended by " << kThreads << " threads: " << frozen.size() << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+    return 0;
+}
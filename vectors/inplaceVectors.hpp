@@ -0,0 +1,403 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <initializer_list>
+
+#include "utils/relocate.hpp"
+
+/**
+ * 容量固定为N的向量, 元素全部存放在对象内部, 任何操作都不会调用分配器
+ * 接口与@code{Vectors}一致; 超出容量时:
+ * 1. push_back/emplace_back/insert/resize等抛出std::bad_alloc(与std::inplace_vector相同), 向量保持不变
+ * 2. try_push_back/try_emplace_back返回nullptr, 不抛出异常, 用于不允许异常的实时路径
+ * T是trivially copyable时整个对象也是trivially copyable, 可以直接memcpy进共享内存的消息中
+ * @tparam T
+ * @tparam N 容量
+ */
+template<class T, size_t N>
+class InplaceVectors {
+    static_assert(N > 0, "InplaceVectors needs a positive capacity");
+private:
+    size_t m_size;
+    alignas(T) unsigned char m_storage[N * sizeof(T)];
+
+public:
+    using value_type = T;
+
+    InplaceVectors() noexcept : m_size(0) {};
+
+    explicit InplaceVectors(size_t size) : m_size(0) {
+        resize(size);
+    }
+
+    explicit InplaceVectors(size_t size, T const& val) : m_size(0) {
+        resize(size, val);
+    }
+
+    InplaceVectors(std::initializer_list<T> list) : InplaceVectors(list.begin(), list.end()){};
+
+    template<std::random_access_iterator InputIt>
+    explicit InplaceVectors(InputIt first, InputIt last) : m_size(0) {
+        assign(first, last);
+    }
+
+    /* T是trivially copyable时使用默认的拷贝/移动/析构, 整个对象按字节复制 */
+
+    InplaceVectors(InplaceVectors const&) requires std::is_trivially_copy_constructible_v<T> = default;
+
+    InplaceVectors(InplaceVectors const& that) : m_size(0) {
+        assign(that.begin(), that.end());
+    }
+
+    InplaceVectors(InplaceVectors&&) requires std::is_trivially_move_constructible_v<T> = default;
+
+    /**
+     * 逐个搬迁对方的元素, 之后对方为空
+     * @param that
+     */
+    InplaceVectors(InplaceVectors&& that) noexcept(std::is_nothrow_move_constructible_v<T>) : m_size(0) {
+        uninitialized_relocate_n(that.data(), that.m_size, data());
+        m_size = that.m_size;
+        that.m_size = 0;
+    }
+
+    InplaceVectors& operator=(InplaceVectors const&)
+        requires std::is_trivially_copy_assignable_v<T> && std::is_trivially_destructible_v<T> = default;
+
+    InplaceVectors& operator=(InplaceVectors const& that) {
+        if (this == &that) return *this;
+        assign(that.begin(), that.end());
+        return *this;
+    }
+
+    InplaceVectors& operator=(InplaceVectors&&)
+        requires std::is_trivially_move_assignable_v<T> && std::is_trivially_destructible_v<T> = default;
+
+    InplaceVectors& operator=(InplaceVectors&& that) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this == &that) return *this;
+        clear();
+        uninitialized_relocate_n(that.data(), that.m_size, data());
+        m_size = that.m_size;
+        that.m_size = 0;
+        return *this;
+    }
+
+    ~InplaceVectors() requires std::is_trivially_destructible_v<T> = default;
+
+    ~InplaceVectors() {
+        clear();
+    }
+
+    template<std::random_access_iterator InputIt>
+    void assign(InputIt first, InputIt last) {
+        size_t n = last - first;
+        M_check(n);
+        clear();
+        for (size_t i = 0; i < n; i++) {
+            std::construct_at(&data()[i], *first);
+            first++;
+            m_size += 1;
+        }
+    }
+
+    void assign(size_t n, T const& val) {
+        M_check(n);
+        T tmp(val);
+        clear();
+        for (size_t i = 0; i < n; i++) {
+            std::construct_at(&data()[i], std::as_const(tmp));
+            m_size += 1;
+        }
+    }
+
+    void assign(std::initializer_list<T> list) {
+        assign(list.begin(), list.end());
+    }
+
+    template<std::random_access_iterator InputIt>
+    T* insert(T const* it, InputIt first, InputIt last) {
+        size_t n = last - first, j = it - data();
+        if (n == 0) return const_cast<T *> (it);
+        M_check(m_size + n);
+        relocate_overlapping(data() + j, m_size - j, data() + j + n);
+        M_fill_gap(j, n, [&](T* p) { std::construct_at(p, *first); first++; });
+        return data() + j;
+    }
+
+    T* insert(T const* it, T const& val) {
+        return emplace(it, val);
+    }
+
+    T* insert(T const* it, T&& val) {
+        return emplace(it, std::move(val));
+    }
+
+    T* insert(T const* it, size_t n, T const& val) {
+        size_t j = it - data();
+        if (n == 0) return const_cast<T *> (it);
+        M_check(m_size + n);
+        T tmp(val);
+        relocate_overlapping(data() + j, m_size - j, data() + j + n);
+        M_fill_gap(j, n, [&](T* p) { std::construct_at(p, std::as_const(tmp)); });
+        return data() + j;
+    }
+
+    T* insert(T const* it, std::initializer_list<T> list) {
+        return insert(it, list.begin(), list.end());
+    }
+
+    /**
+     * 在it处构造新元素, args可以引用本向量中的元素
+     */
+    template<class ...Args>
+    T* emplace(T const* it, Args &&... args) {
+        size_t j = it - data();
+        M_check(m_size + 1);
+        T tmp(std::forward<Args>(args)...);
+        relocate_overlapping(data() + j, m_size - j, data() + j + 1);
+        std::construct_at(&data()[j], std::move(tmp));
+        m_size += 1;
+        return data() + j;
+    }
+
+    /**
+     * 内联存储无法交换指针, 统一用三次move完成
+     * @param that
+     */
+    void swap(InplaceVectors& that) {
+        InplaceVectors tmp(std::move(that));
+        that = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    void clear() noexcept {
+        std::destroy_n(data(), m_size);
+        m_size = 0;
+    }
+
+    void resize(size_t size) {
+        if (size < m_size) {
+            erase(size, m_size);
+            return;
+        }
+        M_check(size);
+        for (size_t i = m_size; i < size; i++) {
+            std::construct_at(&data()[i]);
+            m_size += 1;
+        }
+    }
+
+    void resize(size_t size, T const& val) {
+        if (size < m_size) {
+            erase(size, m_size);
+            return;
+        }
+        M_check(size);
+        for (size_t i = m_size; i < size; i++) {
+            std::construct_at(&data()[i], val);
+            m_size += 1;
+        }
+    }
+
+    /**
+     * 容量固定, 只检查n是否超过N
+     * @param n
+     */
+    void reserve(size_t n) const {
+        M_check(n);
+    }
+
+    void shrink_to_fit() noexcept {}
+
+    [[nodiscard]] T const& at(size_t i) const {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return data()[i];
+    }
+
+    T& at(size_t i) {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return data()[i];
+    }
+
+    [[nodiscard]] T const& front() const {
+        return at(0);
+    }
+
+    T& front() {
+        return at(0);
+    }
+
+    [[nodiscard]] T const& back() const {
+        return at(m_size - 1);
+    }
+
+    T& back() {
+        return at(m_size - 1);
+    }
+
+    T* begin() noexcept {
+        return data();
+    }
+
+    [[nodiscard]] T const *begin() const noexcept {
+        return data();
+    }
+
+    [[nodiscard]] T const *cbegin() const noexcept {
+        return data();
+    }
+
+    T* end() noexcept {
+        return data() + m_size;
+    }
+
+    [[nodiscard]] T const *end() const noexcept {
+        return data() + m_size;
+    }
+
+    [[nodiscard]] T const *cend() const noexcept {
+        return data() + m_size;
+    }
+
+    std::reverse_iterator<T *> rbegin() noexcept {
+        return std::make_reverse_iterator(end());
+    }
+
+    std::reverse_iterator<T *> rend() noexcept {
+        return std::make_reverse_iterator(begin());
+    }
+
+    [[nodiscard]] std::reverse_iterator<T const*> crbegin() const noexcept {
+        return std::make_reverse_iterator(cend());
+    }
+
+    [[nodiscard]] std::reverse_iterator<T const*> crend() const noexcept {
+        return std::make_reverse_iterator(cbegin());
+    }
+
+    /**
+     * 容量已满时抛出std::bad_alloc
+     * @param val
+     */
+    void push_back(T const& val) {
+        emplace_back(val);
+    }
+
+    void push_back(T &&val) {
+        emplace_back(std::move(val));
+    }
+
+    template<class ...Args>
+    T& emplace_back(Args &&... args) {
+        M_check(m_size + 1);
+        return *M_emplace_back(std::forward<Args>(args)...);
+    }
+
+    /**
+     * 容量已满时返回nullptr, 向量不变; 否则返回新元素的地址
+     * @param val
+     * @return
+     */
+    T* try_push_back(T const& val) {
+        return try_emplace_back(val);
+    }
+
+    T* try_push_back(T&& val) {
+        return try_emplace_back(std::move(val));
+    }
+
+    template<class ...Args>
+    T* try_emplace_back(Args &&... args) {
+        if (m_size == N) [[unlikely]] return nullptr;
+        return M_emplace_back(std::forward<Args>(args)...);
+    }
+
+    void pop_back() {
+        m_size -= 1;
+        std::destroy_at(&data()[m_size]);
+    }
+
+    void erase(size_t i) {
+        erase(i, i + 1);
+    }
+
+    void erase(size_t beg, size_t end) {
+        size_t diff = end - beg;
+        if (diff == 0) return;
+        std::destroy(data() + beg, data() + end);
+        relocate_overlapping(data() + end, m_size - end, data() + beg);
+        m_size -= diff;
+    }
+
+    T* erase(T const* it) {
+        size_t i = it - data();
+        erase(i, i + 1);
+        return data() + i;
+    }
+
+    T* erase(T const* first, T const* last) {
+        size_t i = first - data();
+        erase(i, static_cast<size_t>(last - data()));
+        return data() + i;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return m_size;
+    }
+
+    [[nodiscard]] static constexpr size_t capacity() noexcept {
+        return N;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    [[nodiscard]] bool full() const noexcept {
+        return m_size == N;
+    }
+
+    T* data() noexcept {
+        return reinterpret_cast<T *>(m_storage);
+    }
+
+    [[nodiscard]] T const* data() const noexcept {
+        return reinterpret_cast<T const *>(m_storage);
+    }
+
+    T const& operator[](size_t i) const {
+        return data()[i];
+    }
+
+    T& operator[](size_t i) {
+        return data()[i];
+    }
+
+private:
+    static void M_check(size_t n) {
+        if (n > N) [[unlikely]] throw std::bad_alloc();
+    }
+
+    template<class ...Args>
+    T* M_emplace_back(Args &&... args) {
+        T* p = &data()[m_size];
+        std::construct_at(p, std::forward<Args>(args)...);
+        m_size += 1;
+        return p;
+    }
+
+    /**
+     * [j, j + n)已经腾出, 逐个构造; 中途抛出异常时析构已经构造的元素并把尾部搬回去
+     */
+    template<class Construct>
+    void M_fill_gap(size_t j, size_t n, Construct construct) {
+        uninitialized_fill_gap(data() + j, n, m_size - j, construct);
+        m_size += n;
+    }
+};
@@ -0,0 +1,88 @@
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+#include "inplaceVectors.hpp"
+
+struct Message {
+    int type;
+    InplaceVectors<double, 16> samples;
+};
+
+static_assert(std::is_trivially_copyable_v<InplaceVectors<int, 8>>);
+static_assert(std::is_trivially_copyable_v<Message>);
+static_assert(!std::is_trivially_copyable_v<InplaceVectors<std::string, 8>>);
+static_assert(sizeof(InplaceVectors<int, 8>) == sizeof(size_t) + 8 * sizeof(int));
+
+int main() {
+    /* 与Vectors相同的接口 */
+    {
+        InplaceVectors<int, 8> arr = {1, 2, 3};
+        arr.insert(arr.begin(), 0);
+        arr.insert(arr.end(), 2, 9);
+        arr.erase(arr.begin() + 4);
+        arr.emplace_back(4);
+        for (int x: arr) {
+            std::cout << x << " ";
+        }
+        std::cout << std::endl;
+        assert(arr.size() == 6 && arr.front() == 0 && arr.back() == 4 && arr[4] == 9);
+        assert(*arr.rbegin() == 4 && *arr.crbegin() == 4);
+
+        /* 容量已满: try_push_back返回nullptr, push_back抛出异常, 内容不变 */
+        arr.resize(8, 7);
+        assert(arr.full() && arr.try_push_back(1) == nullptr && arr.try_emplace_back(2) == nullptr);
+        bool thrown = false;
+        try {
+            arr.insert(arr.begin(), 5);
+        } catch (std::bad_alloc const&) {
+            thrown = true;
+        }
+        assert(thrown && arr.size() == 8 && arr[0] == 0);
+        arr.pop_back();
+        int* p = arr.try_push_back(42);
+        assert(p == &arr[7] && *p == 42);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 非trivial的元素: 拷贝, 移动, 引用自身元素的insert */
+    {
+        InplaceVectors<std::string, 4> words = {"alpha", std::string(64, 'b')};
+        words.insert(words.begin(), words[1]);
+        assert(words.size() == 3 && words[0] == words[2]);
+        InplaceVectors<std::string, 4> copy = words;
+        InplaceVectors<std::string, 4> moved = std::move(copy);
+        assert(copy.empty() && moved.size() == 3 && moved[1] == "alpha");
+        moved.swap(words);
+        words.erase(words.begin(), words.begin() + 2);
+        assert(words.size() == 1 && words[0] == std::string(64, 'b'));
+
+        bool thrown = false;
+        try {
+            std::string more[] = {"x", "y"};
+            words.insert(words.begin(), more, more + 2);
+            words.insert(words.end(), more, more + 2);
+        } catch (std::bad_alloc const&) {
+            thrown = true;
+        }
+        assert(thrown && words.size() == 3 && words[0] == "x" && words[2] == std::string(64, 'b'));
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* trivially copyable: 直接memcpy进一块"共享内存" */
+    {
+        Message msg{7, {}};
+        for (int i = 0; i < 10; i++) {
+            msg.samples.push_back(i * 0.5);
+        }
+        alignas(Message) unsigned char shm[sizeof(Message)];
+        std::memcpy(shm, &msg, sizeof(Message));
+        Message received;
+        std::memcpy(&received, shm, sizeof(Message));
+        assert(received.type == 7 && received.samples.size() == 10 && received.samples[9] == 4.5);
+        std::cout << "message: " << sizeof(Message) << " bytes, " << received.samples.size() << " samples" << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+    return 0;
+}
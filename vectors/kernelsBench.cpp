@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+
+#include "kernels.hpp"
+
+/**
+ * 对比kernels与用户代码中常见的begin()/end()标量循环
+ * 标量循环放在noinline函数中, 避免被编译器和测试数据一起常量折叠
+ */
+template <class F>
+double best_of(int rounds, F&& f) {
+    double best = 1e300;
+    for (int r = 0; r < rounds; r++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+template <class T>
+[[gnu::noinline]] size_t scalar_find(Vectors<T>& vec, T x) {
+    for (T* it = vec.begin(); it != vec.end(); ++it) {
+        if (*it == x) return it - vec.begin();
+    }
+    return vec.size();
+}
+
+template <class T>
+[[gnu::noinline]] size_t scalar_count(Vectors<T>& vec, T x) {
+    size_t c = 0;
+    for (T* it = vec.begin(); it != vec.end(); ++it) {
+        if (*it == x) c++;
+    }
+    return c;
+}
+
+template <class T>
+[[gnu::noinline]] T scalar_max(Vectors<T>& vec) {
+    T m = vec[0];
+    for (T* it = vec.begin(); it != vec.end(); ++it) {
+        if (*it > m) m = *it;
+    }
+    return m;
+}
+
+template <class T>
+[[gnu::noinline]] kernels::sum_t<T> scalar_sum(Vectors<T>& vec) {
+    kernels::sum_t<T> s = 0;
+    for (T* it = vec.begin(); it != vec.end(); ++it) {
+        s += *it;
+    }
+    return s;
+}
+
+template <class T>
+[[gnu::noinline]] kernels::sum_t<T> scalar_dot(Vectors<T>& a, Vectors<T>& b) {
+    kernels::sum_t<T> s = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        s += static_cast<kernels::sum_t<T>>(a[i]) * b[i];
+    }
+    return s;
+}
+
+void report(char const* type, char const* op, double scalar_ms, double kernel_ms) {
+    std::cout << std::left << std::setw(10) << type << std::setw(10) << op
+              << "scalar: " << std::setw(10) << scalar_ms
+              << "kernel: " << std::setw(10) << kernel_ms
+              << "speedup: " << scalar_ms / kernel_ms << "x" << std::endl;
+}
+
+template <class T>
+void bench(char const* type, size_t n) {
+    Vectors<T> a(n), b(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = static_cast<T>(i % 100);
+        b[i] = static_cast<T>(i % 7);
+    }
+    T missing = static_cast<T>(101);
+    volatile size_t sink_idx = 0;
+    volatile double sink = 0;
+    constexpr int rounds = 5;
+
+    report(type, "find",
+           best_of(rounds, [&] { sink_idx = scalar_find(a, missing); }),
+           best_of(rounds, [&] { sink_idx = kernels::find(a, missing); }));
+    report(type, "count",
+           best_of(rounds, [&] { sink_idx = scalar_count(a, static_cast<T>(42)); }),
+           best_of(rounds, [&] { sink_idx = kernels::count(a, static_cast<T>(42)); }));
+    report(type, "max",
+           best_of(rounds, [&] { sink = static_cast<double>(scalar_max(a)); }),
+           best_of(rounds, [&] { sink = static_cast<double>(kernels::max(a)); }));
+    report(type, "sum",
+           best_of(rounds, [&] { sink = static_cast<double>(scalar_sum(a)); }),
+           best_of(rounds, [&] { sink = static_cast<double>(kernels::sum(a)); }));
+    report(type, "dot",
+           best_of(rounds, [&] { sink = static_cast<double>(scalar_dot(a, b)); }),
+           best_of(rounds, [&] { sink = static_cast<double>(kernels::dot(a, b)); }));
+    (void) sink_idx;
+    (void) sink;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::stoull(argv[1]) : size_t(1) << 24;
+    std::cout << "isa: " << kernels::isa_name(kernels::active_isa()) << " n: " << n << " (ms, best of 5)" << std::endl;
+    std::cout << "-----------------------------" << std::endl;
+    bench<int8_t>("int8_t", n);
+    bench<int16_t>("int16_t", n);
+    bench<int32_t>("int32_t", n);
+    bench<int64_t>("int64_t", n);
+    bench<float>("float", n);
+    bench<double>("double", n);
+    return 0;
+}
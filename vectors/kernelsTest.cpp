@@ -0,0 +1,91 @@
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include "kernels.hpp"
+
+/**
+ * 与最朴素的循环对比结果, 覆盖不是块大小整数倍的长度
+ */
+template <class T>
+void check(char const* name) {
+    for (size_t n: {1, 7, 64, 255, 1000, 4099}) {
+        Vectors<T> vec;
+        for (size_t i = 0; i < n; i++) {
+            vec.push_back(static_cast<T>((i * 37 + 11) % 101));
+        }
+        T target = vec[n / 2];
+
+        size_t first = n, cnt = 0;
+        T lo = vec[0], hi = vec[0];
+        kernels::sum_t<T> total = 0, prod = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (vec[i] == target) {
+                if (first == n) first = i;
+                cnt++;
+            }
+            lo = vec[i] < lo ? vec[i] : lo;
+            hi = vec[i] > hi ? vec[i] : hi;
+            total += vec[i];
+            prod += static_cast<kernels::sum_t<T>>(vec[i]) * vec[i];
+        }
+
+        assert(kernels::find(vec, target) == first);
+        assert(kernels::count(vec, target) == cnt);
+        assert(kernels::contains(vec, target) && !kernels::contains(vec, static_cast<T>(127)));
+        assert(kernels::min(vec) == lo && kernels::max(vec) == hi);
+        if constexpr (std::is_floating_point_v<T>) {
+            assert(std::abs(kernels::sum(vec) - total) <= 1e-3 * std::abs(total));
+            assert(std::abs(kernels::dot(vec, vec) - prod) <= 1e-3 * std::abs(prod));
+        } else {
+            assert(kernels::sum(vec) == total && kernels::dot(vec, vec) == prod);
+        }
+
+        kernels::transform(vec, [](T v) { return static_cast<T>(v + 1); });
+        assert(vec[0] == static_cast<T>(12));
+    }
+    std::cout << name << ": ok" << std::endl;
+}
+
+int main() {
+    std::cout << "active isa: " << kernels::isa_name(kernels::active_isa()) << std::endl;
+    std::cout << "-----------------------------" << std::endl;
+    check<int8_t>("int8_t");
+    check<uint8_t>("uint8_t");
+    check<int16_t>("int16_t");
+    check<int32_t>("int32_t");
+    check<uint32_t>("uint32_t");
+    check<int64_t>("int64_t");
+    check<float>("float");
+    check<double>("double");
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 各个指令集版本的结果一致 */
+    Vectors<int32_t> vec(10000);
+    for (size_t i = 0; i < vec.size(); i++) {
+        vec[i] = static_cast<int32_t>(i % 1000);
+    }
+    size_t scalar = kernels::detail::count_scalar(vec.cbegin(), vec.size(), 999);
+    assert(scalar == 10);
+    assert(kernels::count_less(vec.cbegin(), vec.size(), 10) == 100);
+    Vectors<int32_t> sorted(vec.cbegin(), vec.cend());
+    std::sort(sorted.begin(), sorted.end());
+    for (int32_t x: {-1, 0, 1, 500, 999, 1000}) {
+        size_t expected = std::lower_bound(sorted.cbegin(), sorted.cend(), x) - sorted.cbegin();
+        assert(kernels::count_less(sorted.cbegin(), sorted.size(), x) == expected);
+    }
+#if KERNELS_X86
+    if (kernels::active_isa() >= kernels::Isa::Avx2) {
+        assert(kernels::detail::count_avx2(vec.cbegin(), vec.size(), 999) == scalar);
+        assert(kernels::detail::find_avx2(vec.cbegin(), vec.size(), 999) == 999);
+    }
+    if (kernels::active_isa() == kernels::Isa::Avx512) {
+        assert(kernels::detail::count_avx512(vec.cbegin(), vec.size(), 999) == scalar);
+        assert(kernels::detail::count_less_avx512(vec.cbegin() + 3, 37, 500) == kernels::detail::count_less_scalar(vec.cbegin() + 3, 37, 500));
+        assert(kernels::detail::sum_avx512(vec.cbegin(), vec.size()) == kernels::detail::sum_scalar(vec.cbegin(), vec.size()));
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+enum class MapMode {
+    /** 共享的只读映射, 能看到其他进程对文件的修改; 通过非const的访问接口写入会触发SIGSEGV, 不会抛出异常 */
+    ReadOnly,
+    /** 私有映射, 可以修改, 但修改不会写回文件 */
+    CopyOnWrite,
+    /** 共享映射, 修改写回文件, 可以push_back扩大文件; 文件不存在时创建 */
+    ReadWrite
+};
+
+enum class MapAdvice {
+    Normal,
+    Sequential,
+    Random,
+    WillNeed,
+    DontNeed
+};
+
+/**
+ * 把由定长记录组成的文件映射为数组, 读接口与@code{Vectors}相同
+ * 打开时只建立映射, 页面在第一次访问时才由内核读入, 不需要整体读取和拷贝
+ * 改变元素个数的操作(push_back, resize等)只在ReadWrite模式下可用, 其他模式下抛出std::logic_error
+ * @tparam T 必须是trivially copyable的类型, 文件大小必须是sizeof(T)的整数倍
+ */
+template<class T>
+class MappedVectors {
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVectors requires a trivially copyable element type");
+private:
+    int m_fd;
+    MapMode m_mode;
+
+    T* m_data;
+    size_t m_size;
+    /** 已经映射(同时也是文件中已经分配)的元素个数, 只有ReadWrite模式下会大于m_size */
+    size_t m_capacity;
+
+public:
+    explicit MappedVectors(std::string const& path, MapMode mode = MapMode::ReadOnly)
+    : m_fd(-1), m_mode(mode), m_data(nullptr), m_size(0), m_capacity(0) {
+        int flags = mode == MapMode::ReadWrite ? O_RDWR | O_CREAT : O_RDONLY;
+        m_fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (m_fd < 0) S_throw("MappedVectors: open " + path);
+
+        struct stat st{};
+        if (fstat(m_fd, &st) != 0) {
+            ::close(m_fd);
+            S_throw("MappedVectors: fstat " + path);
+        }
+        auto bytes = static_cast<size_t>(st.st_size);
+        if (bytes % sizeof(T) != 0) {
+            ::close(m_fd);
+            throw std::runtime_error("MappedVectors: size of " + path + " is not a multiple of the element size");
+        }
+        m_size = m_capacity = bytes / sizeof(T);
+        if (m_capacity != 0) {
+            try {
+                M_map(m_capacity);
+            } catch (...) {
+                ::close(m_fd);
+                throw;
+            }
+        }
+    }
+
+    MappedVectors(MappedVectors const&) = delete;
+    MappedVectors& operator=(MappedVectors const&) = delete;
+
+    MappedVectors(MappedVectors&& that) noexcept
+    : m_fd(std::exchange(that.m_fd, -1)), m_mode(that.m_mode),
+      m_data(std::exchange(that.m_data, nullptr)),
+      m_size(std::exchange(that.m_size, 0)), m_capacity(std::exchange(that.m_capacity, 0)) {};
+
+    MappedVectors& operator=(MappedVectors&& that) noexcept {
+        if (this == &that) return *this;
+        M_close();
+        m_fd = std::exchange(that.m_fd, -1);
+        m_mode = that.m_mode;
+        m_data = std::exchange(that.m_data, nullptr);
+        m_size = std::exchange(that.m_size, 0);
+        m_capacity = std::exchange(that.m_capacity, 0);
+        return *this;
+    }
+
+    ~MappedVectors() { M_close(); }
+
+    /**
+     * 告诉内核接下来的访问模式, 例如顺序扫描时加大预读, 随机访问时关闭预读
+     * @param advice
+     */
+    void advise(MapAdvice advice) {
+        if (m_data == nullptr) return;
+        int flag = MADV_NORMAL;
+        switch (advice) {
+            case MapAdvice::Normal: flag = MADV_NORMAL; break;
+            case MapAdvice::Sequential: flag = MADV_SEQUENTIAL; break;
+            case MapAdvice::Random: flag = MADV_RANDOM; break;
+            case MapAdvice::WillNeed: flag = MADV_WILLNEED; break;
+            case MapAdvice::DontNeed: flag = MADV_DONTNEED; break;
+        }
+        if (madvise(m_data, m_capacity * sizeof(T), flag) != 0) S_throw("MappedVectors: madvise");
+    }
+
+    /**
+     * ReadWrite模式下扩大文件并重新映射, 已有元素的内容不变
+     * @param n
+     */
+    void reserve(size_t n) {
+        if (n <= m_capacity) [[likely]] return;
+        M_require_writable("reserve");
+        n = std::max(n, m_capacity * 2);
+        if (ftruncate(m_fd, static_cast<off_t>(n * sizeof(T))) != 0) S_throw("MappedVectors: ftruncate");
+        M_map(n);
+    }
+
+    /**
+     * ReadWrite模式下改变元素个数, 新增的元素为0
+     * 之前pop_back或者缩小过的位置还留着旧的内容, 扩大时需要清零
+     * @param size
+     */
+    void resize(size_t size) {
+        M_require_writable("resize");
+        reserve(size);
+        if (size > m_size) {
+            std::memset(static_cast<void *>(m_data + m_size), 0, (size - m_size) * sizeof(T));
+        }
+        m_size = size;
+    }
+
+    void push_back(T const& val) {
+        emplace_back(val);
+    }
+
+    template<class ...Args>
+    T& emplace_back(Args &&... args) {
+        M_require_writable("emplace_back");
+        if (m_size + 1 > m_capacity) [[unlikely]] {
+            // 参数可能引用映射中的元素, 重新映射前先构造出来
+            T tmp(std::forward<Args>(args)...);
+            reserve(m_size + 1);
+            m_data[m_size] = tmp;
+        } else {
+            std::construct_at(&m_data[m_size], std::forward<Args>(args)...);
+        }
+        return m_data[m_size++];
+    }
+
+    void pop_back() {
+        M_require_writable("pop_back");
+        m_size -= 1;
+    }
+
+    /**
+     * 把修改过的页写回文件
+     */
+    void sync() {
+        if (m_mode != MapMode::ReadWrite || m_data == nullptr) return;
+        if (msync(m_data, m_capacity * sizeof(T), MS_SYNC) != 0) S_throw("MappedVectors: msync");
+    }
+
+    [[nodiscard]] T const& at(size_t i) const {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return m_data[i];
+    }
+
+    /**
+     * 只检查下标; ReadOnly模式下写入返回的引用会触发SIGSEGV, 见@code{operator[]}
+     */
+    T& at(size_t i) {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return m_data[i];
+    }
+
+    [[nodiscard]] T const& front() const {
+        return at(0);
+    }
+
+    [[nodiscard]] T const& back() const {
+        return at(m_size - 1);
+    }
+
+    T* begin() {
+        return m_data;
+    }
+
+    [[nodiscard]] T const* begin() const {
+        return m_data;
+    }
+
+    [[nodiscard]] T const* cbegin() const {
+        return m_data;
+    }
+
+    T* end() {
+        return m_data + m_size;
+    }
+
+    [[nodiscard]] T const* end() const {
+        return m_data + m_size;
+    }
+
+    [[nodiscard]] T const* cend() const {
+        return m_data + m_size;
+    }
+
+    [[nodiscard]] std::reverse_iterator<T const*> crbegin() const {
+        return std::make_reverse_iterator(cend());
+    }
+
+    [[nodiscard]] std::reverse_iterator<T const*> crend() const {
+        return std::make_reverse_iterator(cbegin());
+    }
+
+    [[nodiscard]] T const* data() const noexcept {
+        return m_data;
+    }
+
+    T* data() noexcept {
+        return m_data;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return m_size;
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return m_capacity;
+    }
+
+    [[nodiscard]] MapMode mode() const noexcept {
+        return m_mode;
+    }
+
+    T const& operator[](size_t i) const {
+        return m_data[i];
+    }
+
+    /**
+     * ReadOnly模式下映射没有写权限, 通过返回的引用写入会触发SIGSEGV而不是抛出异常;
+     * 非const的at(), begin()/end()和data()同样如此, 只读访问请使用const接口
+     */
+    T& operator[](size_t i) {
+        return m_data[i];
+    }
+
+private:
+    [[noreturn]] static void S_throw(std::string const& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    void M_require_writable(char const* op) const {
+        if (m_mode != MapMode::ReadWrite) {
+            throw std::logic_error(std::string("MappedVectors::") + op + " requires MapMode::ReadWrite");
+        }
+    }
+
+    /**
+     * 映射文件的前n个元素; 已经有映射时用mremap扩大, 页表之外的内容不需要拷贝
+     * @param n
+     */
+    void M_map(size_t n) {
+        size_t bytes = n * sizeof(T);
+        void* p;
+#ifdef __linux__
+        if (m_data != nullptr) {
+            p = mremap(m_data, m_capacity * sizeof(T), bytes, MREMAP_MAYMOVE);
+        } else
+#endif
+        {
+            int prot = m_mode == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+            int flags = m_mode == MapMode::CopyOnWrite ? MAP_PRIVATE : MAP_SHARED;
+            p = mmap(nullptr, bytes, prot, flags, m_fd, 0);
+            if (p != MAP_FAILED && m_data != nullptr) munmap(m_data, m_capacity * sizeof(T));
+        }
+        if (p == MAP_FAILED) S_throw("MappedVectors: mmap");
+        m_data = static_cast<T *>(p);
+        m_capacity = n;
+    }
+
+    /**
+     * ReadWrite模式下文件按容量扩大过, 关闭时截断到实际的元素个数
+     */
+    void M_close() noexcept {
+        if (m_data != nullptr) munmap(m_data, m_capacity * sizeof(T));
+        if (m_fd >= 0) {
+            if (m_mode == MapMode::ReadWrite && m_size != m_capacity) {
+                (void) ftruncate(m_fd, static_cast<off_t>(m_size * sizeof(T)));
+            }
+            ::close(m_fd);
+        }
+        m_fd = -1;
+        m_data = nullptr;
+        m_size = m_capacity = 0;
+    }
+};
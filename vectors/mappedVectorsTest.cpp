@@ -0,0 +1,84 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+#include "mappedVectors.hpp"
+
+struct Record {
+    uint64_t id;
+    double value;
+};
+
+int main() {
+    std::string path = "/tmp/mapped_vectors_test_" + std::to_string(getpid()) + ".bin";
+    std::remove(path.c_str());
+
+    /* ReadWrite模式下push_back会扩大文件 */
+    {
+        MappedVectors<Record> records(path, MapMode::ReadWrite);
+        assert(records.size() == 0);
+        for (uint64_t i = 0; i < 100000; i++) {
+            records.push_back({i, i * 0.5});
+        }
+        records.emplace_back(records[0]);
+
+        // pop_back之后再扩大, 新增的元素是0而不是之前的内容
+        records[records.size() - 1] = {7, 3.5};
+        records.pop_back();
+        records.resize(records.size() + 1);
+        assert(records.back().id == 0 && records.back().value == 0);
+        records.sync();
+        std::cout << "written: " << records.size() << " capacity: " << records.capacity() << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 只读映射, 页面按需读入 */
+    {
+        MappedVectors<Record> records(path);
+        records.advise(MapAdvice::Sequential);
+        assert(records.size() == 100001);
+        double total = 0;
+        for (auto const& r: records) {
+            total += r.value;
+        }
+        assert(records[99999].id == 99999 && records.back().id == 0);
+        std::cout << "read-only sum: " << total << std::endl;
+
+        bool thrown = false;
+        try {
+            records.push_back({0, 0});
+        } catch (std::logic_error const&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 私有映射可以修改, 但不会写回文件 */
+    {
+        MappedVectors<Record> cow(path, MapMode::CopyOnWrite);
+        cow.advise(MapAdvice::Random);
+        cow[5].value = -1;
+        assert(cow.at(5).value == -1);
+
+        MappedVectors<Record> moved = std::move(cow);
+        assert(moved.size() == 100001 && cow.size() == 0);
+    }
+    {
+        MappedVectors<Record> records(path);
+        assert(records[5].value == 2.5);
+    }
+
+    bool thrown = false;
+    try {
+        MappedVectors<Record> missing("/nonexistent/dir/file.bin");
+    } catch (std::system_error const& e) {
+        std::cout << "expected error: " << e.what() << std::endl;
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,453 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "vectors.hpp"
+
+/**
+ * @code{Vectors<T>}的二进制持久化
+ * 文件格式: 40字节的头部(magic, 版本, 标志, 元素大小, 元素个数, 数据字节数, 校验和) + 数据, 使用本机字节序
+ * trivially copyable的元素整体读写; 其他类型需要特化@code{serialize::Serializer<T>}
+ * 数据经过一个固定大小的窗口流式读写, 大块数据用writev/readv直接在向量和文件之间传输, 不经过窗口拷贝
+ * 头部记录了数据的字节数, 读取时不会越过当前向量, 因此同一个fd中可以连续保存多个向量
+ */
+namespace serialize {
+
+/**
+ * 非trivially copyable类型的定制点, 特化时提供:
+ * @code{template<class Out> static void write(Out& out, T const& val);} 通过out.write(ptr, bytes)或out.put(x)输出
+ * @code{static T read(Reader& in);} 通过in.read(ptr, bytes)或in.get<X>()读入
+ */
+template<class T>
+struct Serializer;
+
+class Reader;
+
+template<class T>
+concept Custom = requires(Reader& in) {
+    { Serializer<T>::read(in) } -> std::convertible_to<T>;
+};
+
+inline constexpr uint32_t kMagic = 0x53434556; // "VECS"
+inline constexpr uint16_t kVersion = 1;
+inline constexpr size_t kDefaultWindow = size_t(1) << 20;
+
+struct Header {
+    uint32_t magic;
+    uint16_t version;
+    /** bit0: 元素通过Serializer写入, 长度可变 */
+    uint16_t flags;
+    uint32_t elem_size;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t bytes;
+    uint64_t checksum;
+};
+static_assert(sizeof(Header) == 40);
+
+/**
+ * 64位校验和, 4路独立累加(每轮32字节), 可以分多次update
+ * 用于发现截断和损坏, 不是密码学哈希
+ */
+class Checksum {
+private:
+    static constexpr uint64_t P1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t P3 = 0x165667B19E3779F9ULL;
+
+    uint64_t m_acc[4];
+    unsigned char m_pending[32];
+    size_t m_pending_size;
+    uint64_t m_total;
+
+public:
+    Checksum() noexcept
+    : m_acc{P1 + P2, P2, 0, 0 - P1}, m_pending{}, m_pending_size(0), m_total(0) {};
+
+    void update(void const* data, size_t n) noexcept {
+        if (n == 0) return;
+        auto p = static_cast<unsigned char const *>(data);
+        m_total += n;
+        if (m_pending_size != 0) {
+            size_t k = std::min(n, 32 - m_pending_size);
+            std::memcpy(m_pending + m_pending_size, p, k);
+            m_pending_size += k;
+            p += k;
+            n -= k;
+            if (m_pending_size < 32) return;
+            M_stripe(m_pending);
+            m_pending_size = 0;
+        }
+        for (; n >= 32; p += 32, n -= 32) {
+            M_stripe(p);
+        }
+        std::memcpy(m_pending, p, n);
+        m_pending_size = n;
+    }
+
+    [[nodiscard]] uint64_t digest() const noexcept {
+        uint64_t h = S_rotl(m_acc[0], 1) + S_rotl(m_acc[1], 7) + S_rotl(m_acc[2], 12) + S_rotl(m_acc[3], 18);
+        h += m_total;
+        for (size_t i = 0; i < m_pending_size; i++) {
+            h = S_rotl(h ^ (m_pending[i] * P3), 11) * P1;
+        }
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static uint64_t S_rotl(uint64_t x, int r) noexcept {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    void M_stripe(unsigned char const* p) noexcept {
+        for (size_t k = 0; k < 4; k++) {
+            uint64_t w;
+            std::memcpy(&w, p + k * 8, 8);
+            m_acc[k] = S_rotl(m_acc[k] + w * P2, 31) * P1;
+        }
+    }
+};
+
+namespace detail {
+
+[[noreturn]] inline void S_throw(char const* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * 写出iov中的全部数据, 处理部分写入和EINTR
+ */
+inline void S_writev_all(int fd, iovec* iov, int cnt) {
+    while (cnt > 0) {
+        ssize_t k = ::writev(fd, iov, cnt);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            S_throw("serialize: writev");
+        }
+        auto done = static_cast<size_t>(k);
+        while (cnt > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            ++iov;
+            --cnt;
+        }
+        if (cnt > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + done;
+            iov->iov_len -= done;
+        }
+    }
+}
+
+/**
+ * 读入至少need字节, 之后的缓冲区能读多少读多少
+ * @return 读入的总字节数
+ */
+inline size_t S_readv_at_least(int fd, iovec* iov, int cnt, size_t need) {
+    size_t total = 0;
+    while (total < need) {
+        ssize_t k = ::readv(fd, iov, cnt);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            S_throw("serialize: readv");
+        }
+        if (k == 0) throw std::runtime_error("serialize: unexpected end of file");
+        total += static_cast<size_t>(k);
+        auto done = static_cast<size_t>(k);
+        while (cnt > 0 && done >= iov->iov_len) {
+            done -= iov->iov_len;
+            ++iov;
+            --cnt;
+        }
+        if (cnt > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + done;
+            iov->iov_len -= done;
+        }
+    }
+    return total;
+}
+
+/**
+ * 关闭由路径打开的fd
+ */
+struct FdGuard {
+    int fd;
+
+    ~FdGuard() {
+        if (fd >= 0) ::close(fd);
+    }
+};
+
+} // namespace detail
+
+/**
+ * 只计算校验和与字节数, 不产生输出, 用于写出头部之前遍历一遍自定义类型
+ */
+class ChecksumSink {
+private:
+    Checksum m_checksum;
+    uint64_t m_bytes = 0;
+
+public:
+    void write(void const* data, size_t n) noexcept {
+        m_checksum.update(data, n);
+        m_bytes += n;
+    }
+
+    template<class X>
+    void put(X const& x) noexcept {
+        static_assert(std::is_trivially_copyable_v<X>);
+        write(&x, sizeof(X));
+    }
+
+    [[nodiscard]] uint64_t digest() const noexcept {
+        return m_checksum.digest();
+    }
+
+    [[nodiscard]] uint64_t bytes() const noexcept {
+        return m_bytes;
+    }
+};
+
+/**
+ * 经过固定大小窗口写入fd
+ * 小块数据拷贝进窗口, 窗口满时写出; 不小于窗口的数据与窗口中剩余的内容一起用writev写出
+ * 析构时不会自动写出, 结束前需要调用flush()
+ */
+class Writer {
+private:
+    int m_fd;
+    size_t m_window;
+    std::unique_ptr<unsigned char[]> m_buf;
+    size_t m_used;
+
+public:
+    explicit Writer(int fd, size_t window = kDefaultWindow)
+    : m_fd(fd), m_window(std::max<size_t>(window, 64)), m_buf(new unsigned char[m_window]), m_used(0) {};
+
+    Writer(Writer const&) = delete;
+    Writer& operator=(Writer const&) = delete;
+
+    void write(void const* data, size_t n) {
+        if (n == 0) return;
+        if (n < m_window) {
+            if (m_used + n > m_window) flush();
+            std::memcpy(m_buf.get() + m_used, data, n);
+            m_used += n;
+            return;
+        }
+        iovec iov[2] = {{m_buf.get(), m_used}, {const_cast<void *>(data), n}};
+        detail::S_writev_all(m_fd, iov, 2);
+        m_used = 0;
+    }
+
+    template<class X>
+    void put(X const& x) {
+        static_assert(std::is_trivially_copyable_v<X>);
+        write(&x, sizeof(X));
+    }
+
+    void flush() {
+        if (m_used == 0) return;
+        iovec iov{m_buf.get(), m_used};
+        detail::S_writev_all(m_fd, &iov, 1);
+        m_used = 0;
+    }
+};
+
+/**
+ * 经过固定大小窗口从fd读入, 最多读取limit字节, 读入的数据同时计算校验和
+ */
+class Reader {
+private:
+    int m_fd;
+    size_t m_window;
+    std::unique_ptr<unsigned char[]> m_buf;
+    size_t m_pos;
+    size_t m_end;
+    /** 还没有从fd中读出的字节数 */
+    uint64_t m_remaining;
+    Checksum m_checksum;
+
+public:
+    Reader(int fd, uint64_t limit, size_t window = kDefaultWindow)
+    : m_fd(fd), m_window(std::max<size_t>(window, 64)), m_buf(new unsigned char[m_window]),
+      m_pos(0), m_end(0), m_remaining(limit) {};
+
+    Reader(Reader const&) = delete;
+    Reader& operator=(Reader const&) = delete;
+
+    /**
+     * 先取窗口中已有的数据; 剩余的部分按窗口大小直接读入目标内存, 每段读入后马上计算校验和(数据还在缓存中)
+     * 最后不足一个窗口的部分与后续数据一起readv, 目标内存之外的部分留在窗口中
+     */
+    void read(void* data, size_t n) {
+        if (n == 0) return;
+        auto p = static_cast<unsigned char *>(data);
+        size_t k = std::min(n, m_end - m_pos);
+        std::memcpy(p, m_buf.get() + m_pos, k);
+        m_checksum.update(p, k);
+        m_pos += k;
+        p += k;
+        n -= k;
+        if (n == 0) return;
+        if (n > m_remaining) throw std::runtime_error("serialize: record is shorter than its header says");
+
+        while (n >= m_window) {
+            iovec iov{p, m_window};
+            detail::S_readv_at_least(m_fd, &iov, 1, m_window);
+            m_checksum.update(p, m_window);
+            m_remaining -= m_window;
+            p += m_window;
+            n -= m_window;
+        }
+        if (n == 0) return;
+        size_t ahead = static_cast<size_t>(std::min<uint64_t>(m_window, m_remaining - n));
+        iovec iov[2] = {{p, n}, {m_buf.get(), ahead}};
+        size_t got = detail::S_readv_at_least(m_fd, iov, ahead == 0 ? 1 : 2, n);
+        m_checksum.update(p, n);
+        m_remaining -= got;
+        m_pos = 0;
+        m_end = got - n;
+    }
+
+    template<class X>
+    X get() {
+        static_assert(std::is_trivially_copyable_v<X>);
+        X x;
+        read(&x, sizeof(X));
+        return x;
+    }
+
+    [[nodiscard]] uint64_t digest() const noexcept {
+        return m_checksum.digest();
+    }
+
+    /**
+     * 数据是否已经全部读完
+     */
+    [[nodiscard]] bool done() const noexcept {
+        return m_pos == m_end && m_remaining == 0;
+    }
+};
+
+namespace detail {
+
+inline Header S_read_header(int fd) {
+    Header h{};
+    iovec iov{&h, sizeof(h)};
+    S_readv_at_least(fd, &iov, 1, sizeof(h));
+    if (h.magic != kMagic) throw std::runtime_error("serialize: bad magic");
+    if (h.version != kVersion) throw std::runtime_error("serialize: unsupported version");
+    return h;
+}
+
+} // namespace detail
+
+/**
+ * 把vec写入fd的当前位置
+ * trivially copyable的类型先计算一遍校验和, 然后头部和数据一起writev写出, 数据不经过窗口拷贝
+ * 自定义类型先遍历一遍得到校验和与字节数, 再遍历一遍写出
+ */
+template<class T, class Alloc, class Growth>
+void save(int fd, Vectors<T, Alloc, Growth> const& vec, size_t window = kDefaultWindow) {
+    Header h{kMagic, kVersion, 0, sizeof(T), 0, vec.size(), 0, 0};
+    if constexpr (Custom<T>) {
+        ChecksumSink sink;
+        for (T const* it = vec.cbegin(); it != vec.cend(); ++it) {
+            Serializer<T>::write(sink, *it);
+        }
+        h.flags = 1;
+        h.elem_size = 0;
+        h.bytes = sink.bytes();
+        h.checksum = sink.digest();
+        Writer out(fd, window);
+        out.put(h);
+        for (T const* it = vec.cbegin(); it != vec.cend(); ++it) {
+            Serializer<T>::write(out, *it);
+        }
+        out.flush();
+    } else {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "serialize::save requires a trivially copyable type or a serialize::Serializer<T> specialization");
+        Checksum checksum;
+        checksum.update(vec.data(), vec.size() * sizeof(T));
+        h.bytes = vec.size() * sizeof(T);
+        h.checksum = checksum.digest();
+        Writer out(fd, window);
+        out.put(h);
+        out.write(vec.data(), h.bytes);
+        out.flush();
+    }
+}
+
+/**
+ * 从fd的当前位置读取一个向量, 替换vec原来的内容
+ * 根据头部中的元素个数只分配一次内存; 校验和不一致或者数据被截断时抛出std::runtime_error
+ */
+template<class T, class Alloc, class Growth>
+void load(int fd, Vectors<T, Alloc, Growth>& vec, size_t window = kDefaultWindow) {
+    Header h = detail::S_read_header(fd);
+    vec.clear();
+    if (vec.capacity() < h.count) {
+        // 释放旧的内存, 保证只按头部的大小分配一次, 而不是按增长策略分配
+        vec = Vectors<T, Alloc, Growth>(vec.get_allocator(), vec.growth_policy());
+    }
+
+    Reader in(fd, h.bytes, window);
+    if constexpr (Custom<T>) {
+        if (h.flags != 1) throw std::runtime_error("serialize: record was not written by Serializer<T>");
+        vec.reserve(h.count);
+        for (uint64_t i = 0; i < h.count; i++) {
+            vec.emplace_back(Serializer<T>::read(in));
+        }
+    } else {
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "serialize::load requires a trivially copyable type or a serialize::Serializer<T> specialization");
+        if (h.flags != 0 || h.elem_size != sizeof(T) || h.bytes != h.count * sizeof(T)) {
+            throw std::runtime_error("serialize: element size does not match");
+        }
+        vec.resize_for_overwrite(h.count);
+        in.read(vec.data(), h.bytes);
+    }
+    if (!in.done()) throw std::runtime_error("serialize: record is longer than its elements");
+    if (in.digest() != h.checksum) throw std::runtime_error("serialize: checksum mismatch");
+}
+
+template<class T, class Alloc = std::allocator<T>>
+Vectors<T, Alloc> load(int fd, size_t window = kDefaultWindow, Alloc const& alloc = Alloc()) {
+    Vectors<T, Alloc> vec(alloc);
+    load(fd, vec, window);
+    return vec;
+}
+
+template<class T, class Alloc, class Growth>
+void save(std::string const& path, Vectors<T, Alloc, Growth> const& vec, size_t window = kDefaultWindow) {
+    detail::FdGuard guard{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+    if (guard.fd < 0) detail::S_throw(("serialize: open " + path).c_str());
+    save(guard.fd, vec, window);
+}
+
+template<class T, class Alloc, class Growth>
+void load(std::string const& path, Vectors<T, Alloc, Growth>& vec, size_t window = kDefaultWindow) {
+    detail::FdGuard guard{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (guard.fd < 0) detail::S_throw(("serialize: open " + path).c_str());
+    load(guard.fd, vec, window);
+}
+
+} // namespace serialize
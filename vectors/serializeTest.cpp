@@ -0,0 +1,101 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "serialize.hpp"
+
+struct Point {
+    float x, y, z;
+};
+
+/* std::string不是trivially copyable, 通过特化Serializer保存长度和内容 */
+template<>
+struct serialize::Serializer<std::string> {
+    template<class Out>
+    static void write(Out& out, std::string const& s) {
+        out.put(static_cast<uint32_t>(s.size()));
+        out.write(s.data(), s.size());
+    }
+
+    static std::string read(Reader& in) {
+        std::string s(in.get<uint32_t>(), '\0');
+        in.read(s.data(), s.size());
+        return s;
+    }
+};
+
+int main() {
+    std::string path = "/tmp/serialize_test_" + std::to_string(getpid()) + ".bin";
+
+    /* trivially copyable的元素, 窗口远小于数据 */
+    {
+        Vectors<Point> points;
+        for (int i = 0; i < 100000; i++) {
+            points.push_back({float(i), float(i) * 2, float(i) * 3});
+        }
+        serialize::save(path, points, 4096);
+
+        Vectors<Point> loaded;
+        serialize::load(path, loaded, 4096);
+        assert(loaded.size() == points.size() && loaded.capacity() == points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            assert(loaded[i].x == points[i].x && loaded[i].z == points[i].z);
+        }
+        std::cout << "points: " << loaded.size() << " capacity: " << loaded.capacity() << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 自定义类型, 以及同一个fd中连续保存多个向量 */
+    {
+        Vectors<std::string> words = {"alpha", "", "gamma", std::string(5000, 'x')};
+        Vectors<uint64_t> numbers = {1, 2, 3};
+        FILE* f = std::tmpfile();
+        int fd = fileno(f);
+        serialize::save(fd, words, 64);
+        serialize::save(fd, numbers);
+        serialize::save(fd, Vectors<int>());
+        lseek(fd, 0, SEEK_SET);
+
+        auto w = serialize::load<std::string>(fd, 64);
+        assert(w.size() == 4 && w[0] == "alpha" && w[1].empty() && w[3].size() == 5000);
+        auto n = serialize::load<uint64_t>(fd);
+        assert(n.size() == 3 && n[2] == 3);
+        auto e = serialize::load<int>(fd);
+        assert(e.size() == 0);
+        std::cout << "words: " << w[0] << " " << w[2] << " numbers: " << n[0] << n[1] << n[2] << std::endl;
+        std::fclose(f);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 损坏, 截断和类型不匹配 */
+    {
+        auto expect_error = [&](auto&& f) {
+            try {
+                f();
+            } catch (std::runtime_error const& e) {
+                std::cout << "expected error: " << e.what() << std::endl;
+                return;
+            }
+            assert(false);
+        };
+        Vectors<uint32_t> vec(1000, 7);
+        serialize::save(path, vec);
+        Vectors<uint64_t> wrong;
+        expect_error([&] { serialize::load(path, wrong); });
+
+        int fd = ::open(path.c_str(), O_RDWR);
+        unsigned char byte = 0xff;
+        pwrite(fd, &byte, 1, sizeof(serialize::Header) + 123);
+        Vectors<uint32_t> out;
+        expect_error([&] { serialize::load(path, out); });
+
+        ftruncate(fd, sizeof(serialize::Header) + 100);
+        ::close(fd);
+        expect_error([&] { serialize::load(path, out); });
+    }
+
+    std::remove(path.c_str());
+    return 0;
+}
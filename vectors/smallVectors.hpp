@@ -0,0 +1,501 @@
+#pragma once
+
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <stdexcept>
+#include <initializer_list>
+
+#include "utils/relocate.hpp"
+
+/**
+ * 前N个元素直接存放在对象内部的向量, 超过N个之后才向allocator申请内存
+ * 接口与@code{Vectors}一致, 扩容同样走move_if_noexcept + 强异常安全的路径
+ * @tparam T
+ * @tparam N 内联存储的元素个数
+ * @tparam Alloc
+ */
+template<class T, size_t N, class Alloc = std::allocator<T>>
+class SmallVectors {
+    static_assert(N > 0, "SmallVectors needs at least one inline element");
+private:
+    [[no_unique_address]] Alloc allocator;
+
+    T* m_data;
+    size_t m_size;
+    size_t m_capacity;
+
+    /** 内联存储, m_data指向这里时不需要释放 */
+    alignas(T) unsigned char m_inline[N * sizeof(T)];
+
+public:
+    SmallVectors() noexcept : m_data(M_inline_data()), m_size(0), m_capacity(N) {};
+
+    explicit SmallVectors(Alloc const& alloc) noexcept
+    : allocator(alloc), m_data(M_inline_data()), m_size(0), m_capacity(N) {};
+
+    explicit SmallVectors(size_t size) : SmallVectors() {
+        reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            std::construct_at(&m_data[i]);
+        }
+        m_size = size;
+    }
+
+    explicit SmallVectors(size_t size, T const& val) : SmallVectors() {
+        reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            std::construct_at(&m_data[i], val);
+        }
+        m_size = size;
+    }
+
+    SmallVectors(std::initializer_list<T> list) : SmallVectors(list.begin(), list.end()){};
+
+    template<std::random_access_iterator InputIt>
+    explicit SmallVectors(InputIt first, InputIt last) : SmallVectors() {
+        size_t n = last - first;
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            std::construct_at(&m_data[i], *first);
+            first++;
+        }
+        m_size = n;
+    }
+
+    SmallVectors(SmallVectors const& that)
+    : SmallVectors(that, std::allocator_traits<Alloc>::select_on_container_copy_construction(that.allocator)) {};
+
+    /**
+     * 使用指定的分配器深拷贝
+     * @param that
+     * @param alloc
+     */
+    SmallVectors(SmallVectors const& that, Alloc const& alloc) : SmallVectors(alloc) {
+        assign(that.cbegin(), that.cend());
+    }
+
+    /**
+     * 与@code{Vectors}相同, 分配器只在propagate_on_container_copy_assignment为true时跟着拷贝
+     * @param that
+     * @return
+     */
+    SmallVectors& operator=(SmallVectors const& that) {
+        if (this == &that) return *this;
+
+        constexpr bool propagate = std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value;
+        SmallVectors tmp(that, propagate ? that.allocator : allocator);
+        M_take(tmp);
+        return *this;
+    }
+
+    /**
+     * 对方在堆上时直接接管指针; 对方还在内联存储时只能把元素逐个搬过来
+     * @param that
+     */
+    SmallVectors(SmallVectors&& that) noexcept(std::is_nothrow_move_constructible_v<T>) : SmallVectors(that.allocator) {
+        M_steal(that);
+    }
+
+    /**
+     * 使用指定的分配器移动构造; 与that的分配器不相等时不能接管对方的堆内存, 只能逐个move元素
+     * @param that
+     * @param alloc
+     */
+    SmallVectors(SmallVectors&& that, Alloc const& alloc) : SmallVectors(alloc) {
+        if (allocators_equal(allocator, that.allocator)) {
+            M_steal(that);
+            return;
+        }
+        reserve(that.m_size);
+        for (; m_size < that.m_size; m_size++) {
+            std::construct_at(&m_data[m_size], std::move(that.m_data[m_size]));
+        }
+    }
+
+    /**
+     * propagate_on_container_move_assignment为false时保留当前的分配器, 分配器不相等时逐个move元素
+     * @param that
+     * @return
+     */
+    SmallVectors& operator=(SmallVectors&& that)
+    noexcept(std::is_nothrow_move_constructible_v<T>
+             && (std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value
+                 || std::allocator_traits<Alloc>::is_always_equal::value)) {
+        if (this == &that) return *this;
+        if constexpr (!std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value) {
+            SmallVectors tmp(std::move(that), allocator);
+            M_take(tmp);
+        } else {
+            M_take(that);
+        }
+        return *this;
+    }
+
+    template<std::random_access_iterator InputIt>
+    void assign(InputIt first, InputIt last) {
+        clear();
+        size_t n = last - first;
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            std::construct_at(&m_data[i], *first);
+            first++;
+        }
+        m_size = n;
+    }
+
+    void assign(size_t n, T const& val) {
+        clear();
+        reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            std::construct_at(&m_data[i], val);
+        }
+        m_size = n;
+    }
+
+    void assign(std::initializer_list<T> list) {
+        assign(list.begin(), list.end());
+    }
+
+    template<std::random_access_iterator InputIt>
+    T* insert(T const* it, InputIt first, InputIt last) {
+        size_t n = last - first, j = it - m_data;
+        if (n == 0) return const_cast<T *> (it);
+        M_open_gap(j, n);
+        uninitialized_fill_gap(m_data + j, n, m_size - j, [&](T* p) { std::construct_at(p, *first); ++first; });
+        m_size += n;
+        return m_data + j;
+    }
+
+    T* insert(T const* it, T const& val) {
+        size_t j = it - m_data;
+        if (m_size + 1 > m_capacity) {
+            M_realloc_emplace(j, val);
+            return m_data + j;
+        }
+        // val可能引用的是本向量中的元素, 先拷贝出来再移动尾部
+        T tmp(val);
+        relocate_overlapping(m_data + j, m_size - j, m_data + j + 1);
+        std::construct_at(&m_data[j], std::move(tmp));
+        m_size += 1;
+        return m_data + j;
+    }
+
+    T* insert(T const* it, T&& val) {
+        size_t j = it - m_data;
+        if (m_size + 1 > m_capacity) {
+            M_realloc_emplace(j, std::move(val));
+            return m_data + j;
+        }
+        relocate_overlapping(m_data + j, m_size - j, m_data + j + 1);
+        std::construct_at(&m_data[j], std::move(val));
+        m_size += 1;
+        return m_data + j;
+    }
+
+    T* insert(T const* it, size_t n, T const& val) {
+        size_t j = it - m_data;
+        if (n == 0) return const_cast<T *> (it);
+        T tmp(val);
+        M_open_gap(j, n);
+        uninitialized_fill_gap(m_data + j, n, m_size - j, [&](T* p) { std::construct_at(p, std::as_const(tmp)); });
+        m_size += n;
+        return m_data + j;
+    }
+
+    T* insert(T const* it, std::initializer_list<T> list) {
+        return insert(it, list.begin(), list.end());
+    }
+
+    /**
+     * 内联存储无法交换指针, 统一用三次move完成
+     * @param that
+     */
+    void swap(SmallVectors& that) {
+        SmallVectors tmp(std::move(that));
+        that = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    void clear() {
+        std::destroy_n(m_data, m_size);
+        m_size = 0;
+    }
+
+    void resize(size_t size) {
+        if (size < m_size) {
+            erase(size, m_size);
+            return;
+        }
+        reserve(size);
+        for (size_t i = m_size; i < size; i++) {
+            std::construct_at(&m_data[i]);
+        }
+        m_size = size;
+    }
+
+    void resize(size_t size, T const& val) {
+        if (size < m_size) {
+            erase(size, m_size);
+            return;
+        }
+        reserve(size);
+        for (size_t i = m_size; i < size; i++) {
+            std::construct_at(&m_data[i], val);
+        }
+        m_size = size;
+    }
+
+    /**
+     * 元素个数不超过N时搬回内联存储, 否则缩小堆上的内存
+     */
+    void shrink_to_fit() {
+        if (is_inline() || m_size == m_capacity) return;
+        if (m_size <= N) {
+            T* old_data = m_data;
+            size_t old_capacity = m_capacity;
+            uninitialized_relocate_if_noexcept(old_data, m_size, M_inline_data());
+            allocator.deallocate(old_data, old_capacity);
+            m_data = M_inline_data();
+            m_capacity = N;
+            return;
+        }
+        M_reallocate(m_size, m_size, 0);
+    }
+
+    void reserve(size_t n) {
+        if (n <= m_capacity) [[likely]] return;
+        M_reallocate(M_recommend(n), m_size, 0);
+    }
+
+    [[nodiscard]] T const& at(size_t i) const {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return m_data[i];
+    }
+
+    T& at(size_t i) {
+        if (i >= m_size) throw std::out_of_range("vector::at");
+        return m_data[i];
+    }
+
+    [[nodiscard]] T const& front() const {
+        return at(0);
+    }
+
+    T& front() {
+        return at(0);
+    }
+
+    [[nodiscard]] T const& back() const {
+        return at(m_size - 1);
+    }
+
+    T& back() {
+        return at(m_size - 1);
+    }
+
+    T* begin() {
+        return m_data;
+    }
+
+    [[nodiscard]] T const *begin() const {
+        return m_data;
+    }
+
+    [[nodiscard]] T const *cbegin() const {
+        return m_data;
+    }
+
+    T* end() {
+        return m_data + m_size;
+    }
+
+    [[nodiscard]] T const *end() const {
+        return m_data + m_size;
+    }
+
+    [[nodiscard]] T const *cend() const {
+        return m_data + m_size;
+    }
+
+    std::reverse_iterator<T *> rbegin() {
+        return std::make_reverse_iterator(m_data + m_size);
+    }
+
+    std::reverse_iterator<T *> rend() {
+        return std::make_reverse_iterator(m_data);
+    }
+
+    [[nodiscard]] std::reverse_iterator<T const*> crbegin() const {
+        return std::make_reverse_iterator(cend());
+    }
+
+    [[nodiscard]] std::reverse_iterator<T const*> crend() const {
+        return std::make_reverse_iterator(cbegin());
+    }
+
+    void push_back(T const& val) {
+        emplace_back(val);
+    }
+
+    void push_back(T &&val) {
+        emplace_back(std::move(val));
+    }
+
+    template<class ...Args>
+    T& emplace_back(Args &&... args) {
+        if (m_size + 1 > m_capacity) [[unlikely]] {
+            M_realloc_emplace(m_size, std::forward<Args>(args)...);
+            return m_data[m_size - 1];
+        }
+
+        T *p = &m_data[m_size];
+        std::construct_at(p, std::forward<Args>(args)...);
+        m_size += 1;
+        return *p;
+    }
+
+    void pop_back() {
+        m_size -= 1;
+        std::destroy_at(&m_data[m_size]);
+    }
+
+    void erase(size_t i) {
+        erase(i, i + 1);
+    }
+
+    void erase(size_t beg, size_t end) {
+        size_t diff = end - beg;
+        if (diff == 0) return;
+        std::destroy(m_data + beg, m_data + end);
+        relocate_overlapping(m_data + end, m_size - end, m_data + beg);
+        m_size -= diff;
+    }
+
+    T* erase(T const* it) {
+        size_t i = it - m_data;
+        erase(i, i + 1);
+        return m_data + i;
+    }
+
+    T* erase(T const* first, T const* last) {
+        size_t i = first - m_data;
+        erase(i, static_cast<size_t>(last - m_data));
+        return m_data + i;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return m_size;
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return m_capacity;
+    }
+
+    [[nodiscard]] Alloc get_allocator() const noexcept {
+        return allocator;
+    }
+
+    /**
+     * 元素是否还存放在对象内部
+     * @return
+     */
+    [[nodiscard]] bool is_inline() const noexcept {
+        return m_data == M_inline_data();
+    }
+
+    T const& operator[](size_t i) const {
+        return m_data[i];
+    }
+
+    T& operator[](size_t i) {
+        return m_data[i];
+    }
+
+    ~SmallVectors() { M_release(); }
+
+private:
+    [[nodiscard]] T* M_inline_data() noexcept {
+        return reinterpret_cast<T *>(m_inline);
+    }
+
+    [[nodiscard]] T const* M_inline_data() const noexcept {
+        return reinterpret_cast<T const *>(m_inline);
+    }
+
+    [[nodiscard]] size_t M_recommend(size_t n) const noexcept {
+        return std::max(n, m_capacity * 2);
+    }
+
+    /**
+     * 析构所有元素, 如果在堆上则归还内存并回到内联存储
+     */
+    void M_release() noexcept {
+        clear();
+        if (!is_inline()) allocator.deallocate(m_data, m_capacity);
+        m_data = M_inline_data();
+        m_capacity = N;
+    }
+
+    /**
+     * 释放当前的元素, 连同分配器一起接管that的元素
+     * @param that
+     */
+    void M_take(SmallVectors& that) {
+        M_release();
+        allocator = that.allocator;
+        M_steal(that);
+    }
+
+    /**
+     * 接管that的元素, 调用前当前对象必须为空且处于内联状态
+     * @param that
+     */
+    void M_steal(SmallVectors& that) {
+        if (that.is_inline()) {
+            uninitialized_relocate_n(that.m_data, that.m_size, m_data);
+            m_size = that.m_size;
+            that.m_size = 0;
+            return;
+        }
+        m_data = that.m_data;
+        m_size = that.m_size;
+        m_capacity = that.m_capacity;
+
+        that.m_data = that.M_inline_data();
+        that.m_size = 0;
+        that.m_capacity = N;
+    }
+
+    /**
+     * 与@code{Vectors::M_reallocate}相同, 只是旧内存是内联存储时不需要释放
+     * @param n
+     * @param j
+     * @param gap
+     */
+    void M_reallocate(size_t n, size_t j, size_t gap) {
+        T* new_data = allocate_relocate_gap(allocator, n, m_data, m_size, j, gap);
+        if (!is_inline()) allocator.deallocate(m_data, m_capacity);
+        m_data = new_data;
+        m_capacity = n;
+    }
+
+    void M_open_gap(size_t j, size_t n) {
+        if (m_size + n > m_capacity) {
+            M_reallocate(M_recommend(m_size + n), j, n);
+        } else {
+            relocate_overlapping(m_data + j, m_size - j, m_data + j + n);
+        }
+    }
+
+    template<class ...Args>
+    void M_realloc_emplace(size_t j, Args &&... args) {
+        size_t n = M_recommend(m_size + 1);
+        T* new_data = allocate_relocate_emplace(allocator, n, m_data, m_size, j, std::forward<Args>(args)...);
+        if (!is_inline()) allocator.deallocate(m_data, m_capacity);
+        m_data = new_data;
+        m_capacity = n;
+        m_size += 1;
+    }
+};
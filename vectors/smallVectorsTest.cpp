@@ -0,0 +1,146 @@
+#include <cassert>
+#include <string>
+#include <stdexcept>
+
+#include "smallVectors.hpp"
+
+/**
+ * 统计allocator的调用次数, 用于确认内联阶段没有申请内存
+ */
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+    static inline int allocations = 0;
+
+    T* allocate(size_t n) {
+        allocations++;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+};
+
+template <class T, size_t N, class Alloc>
+void printVector(SmallVectors<T, N, Alloc> const& vec, std::string name = "defaultVector") {
+    std::cout << name << (vec.is_inline() ? " (inline): " : " (heap): ");
+    for (auto it = vec.cbegin(); it != vec.cend(); ++it) {
+        std::cout << *it << " ";
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * 第throw_at次拷贝时抛出异常, move不是noexcept, 扩容只能走拷贝路径
+ */
+struct Fragile {
+    static inline int alive = 0, copies = 0, throw_at = -1;
+    int value;
+
+    explicit Fragile(int v) : value(v) { alive++; }
+    Fragile(Fragile const& that) : value(that.value) {
+        if (++copies == throw_at) throw std::runtime_error("copy");
+        alive++;
+    }
+    Fragile(Fragile&& that) noexcept(false) : value(that.value) { alive++; }
+    ~Fragile() { alive--; }
+};
+
+int main() {
+    SmallVectors<int, 8, CountingAllocator<int>> arr;
+    for (int i = 0; i < 7; i++) {
+        arr.push_back(i);
+    }
+    arr.insert(arr.begin() + 2, 100);
+    arr.erase(arr.begin() + 2);
+    arr.push_back(7);
+    printVector(arr, "arr");
+    assert(arr.is_inline() && CountingAllocator<int>::allocations == 0);
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 第9个元素溢出到堆上 */
+    arr.emplace_back(8);
+    arr.insert(arr.begin(), {-2, -1});
+    printVector(arr, "arr");
+    assert(!arr.is_inline() && arr.size() == 11 && arr[0] == -2 && arr.back() == 8);
+    std::cout << "-----------------------------" << std::endl;
+
+    arr.resize(4);
+    arr.shrink_to_fit();
+    printVector(arr, "arr");
+    assert(arr.is_inline() && arr.size() == 4 && arr[3] == 1);
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 内联和堆两种状态之间的移动 */
+    SmallVectors<std::string, 2> inline_strs{"a", "b"};
+    SmallVectors<std::string, 2> heap_strs{"c", "d", "e"};
+    SmallVectors<std::string, 2> moved(std::move(inline_strs));
+    assert(moved.is_inline() && moved.size() == 2 && inline_strs.size() == 0);
+    moved = std::move(heap_strs);
+    assert(!moved.is_inline() && moved.size() == 3 && heap_strs.is_inline());
+    moved.swap(heap_strs);
+    assert(moved.size() == 0 && heap_strs.size() == 3 && heap_strs[2] == "e");
+    heap_strs.assign(1, "x");
+    printVector(heap_strs, "heap_strs");
+
+    SmallVectors<std::string, 2> copied = heap_strs;
+    copied.insert(copied.begin(), 3, copied[0]);
+    printVector(copied, "copied");
+    assert(copied.size() == 4 && copied[3] == "x");
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 从内联存储溢出到堆上时拷贝抛出异常, 原来的元素保持不变 */
+    {
+        Fragile extra(-1);
+        for (int throw_at = 1; throw_at <= 5; throw_at++) {
+            SmallVectors<Fragile, 4> vec;
+            for (int i = 0; i < 4; i++) {
+                vec.emplace_back(i);
+            }
+            Fragile::copies = 0;
+            Fragile::throw_at = throw_at;
+            bool thrown = false;
+            try {
+                vec.insert(vec.begin() + 2, extra);
+            } catch (std::runtime_error const&) {
+                thrown = true;
+            }
+            Fragile::throw_at = -1;
+            assert(thrown && vec.is_inline() && vec.size() == 4 && Fragile::alive == 5);
+            for (int i = 0; i < 4; i++) {
+                assert(vec[i].value == i);
+            }
+        }
+
+        // 内联存储和堆上各自腾出空位后构造新元素时抛出异常, 尾部搬回原处
+        for (bool heap: {false, true}) {
+            for (int k = 1; k <= 4; k++) {
+                SmallVectors<Fragile, 8> vec;
+                vec.reserve(heap ? 16 : 8);
+                for (int i = 0; i < 4; i++) {
+                    vec.emplace_back(i);
+                }
+                // 先拷贝一次val, 之后第k次构造新元素时抛出
+                Fragile::copies = 0;
+                Fragile::throw_at = k + 1;
+                bool thrown = false;
+                try {
+                    vec.insert(vec.begin() + 1, 4, extra);
+                } catch (std::runtime_error const&) {
+                    thrown = true;
+                }
+                Fragile::throw_at = -1;
+                assert(thrown && vec.size() == 4 && vec.is_inline() != heap && Fragile::alive == 5);
+                for (int i = 0; i < 4; i++) {
+                    assert(vec[i].value == i);
+                }
+            }
+        }
+        assert(Fragile::alive == 1);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    std::cout << "sizeof(SmallVectors<int, 8>): " << sizeof(SmallVectors<int, 8>) << std::endl;
+    return 0;
+}
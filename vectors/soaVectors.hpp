@@ -0,0 +1,302 @@
+#pragma once
+
+#include <span>
+#include <tuple>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+
+#include "vectors.hpp"
+
+/**
+ * structure-of-arrays: 每个字段存放在自己的@code{Vectors}列中, 按列扫描时只读取需要的字节
+ * 例如@code{SoaVectors<int, int> points;} 代替 @code{Vectors<S> points; struct S {int x, y;};}
+ * 行访问返回引用各列元素的@code{std::tuple<Fields&...>}, 可以结构化绑定, 也可以整体赋值:
+ * @code{auto [x, y] = points[i]; x += 1; points[j] = std::tuple(1, 2);}
+ * 所有列的容量始终相同, 扩容时一起reserve, push_back中不会出现某一列单独搬迁
+ * @tparam Fields
+ */
+template<class ...Fields>
+class SoaVectors {
+    static_assert(sizeof...(Fields) > 0, "SoaVectors needs at least one column");
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<Fields const&...>;
+
+    template<size_t I>
+    using column_type = std::tuple_element_t<I, value_type>;
+
+    static constexpr size_t columns = sizeof...(Fields);
+
+private:
+    std::tuple<Vectors<Fields>...> m_columns;
+
+    template<bool Const>
+    class Iterator {
+    private:
+        using Owner = std::conditional_t<Const, SoaVectors const, SoaVectors>;
+        Owner* m_owner;
+        size_t m_index;
+
+    public:
+        using difference_type = ptrdiff_t;
+        using value_type = SoaVectors::value_type;
+        using reference = std::conditional_t<Const, const_reference, SoaVectors::reference>;
+
+        Iterator() noexcept : m_owner(nullptr), m_index(0) {};
+        Iterator(Owner* owner, size_t index) noexcept : m_owner(owner), m_index(index) {};
+
+        reference operator*() const {
+            return (*m_owner)[m_index];
+        }
+
+        reference operator[](difference_type k) const {
+            return (*m_owner)[m_index + k];
+        }
+
+        Iterator& operator++() noexcept {
+            ++m_index;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            Iterator tmp = *this;
+            ++m_index;
+            return tmp;
+        }
+
+        Iterator& operator--() noexcept {
+            --m_index;
+            return *this;
+        }
+
+        Iterator& operator+=(difference_type k) noexcept {
+            m_index += k;
+            return *this;
+        }
+
+        Iterator operator+(difference_type k) const noexcept {
+            return Iterator(m_owner, m_index + k);
+        }
+
+        difference_type operator-(Iterator const& that) const noexcept {
+            return static_cast<difference_type>(m_index) - static_cast<difference_type>(that.m_index);
+        }
+
+        [[nodiscard]] size_t index() const noexcept {
+            return m_index;
+        }
+
+        bool operator==(Iterator const& that) const noexcept {
+            return m_index == that.m_index;
+        }
+
+        auto operator<=>(Iterator const& that) const noexcept {
+            return m_index <=> that.m_index;
+        }
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    SoaVectors() = default;
+
+    /**
+     * 每一列都有n个值初始化的元素
+     * @param n
+     */
+    explicit SoaVectors(size_t n) : m_columns(Vectors<Fields>(n)...) {};
+
+    SoaVectors(std::initializer_list<value_type> rows) {
+        reserve(rows.size());
+        for (auto const& row: rows) {
+            push_back(row);
+        }
+    }
+
+    /**
+     * 所有列一起扩容到至少n, 各列的容量保持一致
+     * @param n
+     */
+    void reserve(size_t n) {
+        if (n <= capacity()) return;
+        // 逐列reserve; 某一列失败时已经扩容的列只是容量变大, 元素不受影响
+        std::apply([n](auto&... col) { (col.reserve(n), ...); }, m_columns);
+    }
+
+    void push_back(value_type const& row) {
+        std::apply([this](auto const&... vals) { emplace_back(vals...); }, row);
+    }
+
+    void push_back(value_type&& row) {
+        std::apply([this](auto&&... vals) { emplace_back(std::move(vals)...); }, std::move(row));
+    }
+
+    /**
+     * 每一列各用一个参数构造新元素, 返回新的一行
+     * 某一列构造失败时已经追加的列会被撤销, 各列长度保持一致
+     */
+    template<class ...Args>
+    reference emplace_back(Args &&... args) {
+        static_assert(sizeof...(Args) == columns, "emplace_back takes exactly one argument per column");
+        if (size() == capacity()) [[unlikely]] {
+            // 参数可能引用已有的元素, 扩容之前先构造出来
+            value_type tmp(std::forward<Args>(args)...);
+            reserve(std::max<size_t>(1, capacity() * 2));
+            std::apply([this](auto&... vals) {
+                M_emplace_columns(std::index_sequence_for<Fields...>{}, std::move(vals)...);
+            }, tmp);
+        } else {
+            M_emplace_columns(std::index_sequence_for<Fields...>{}, std::forward<Args>(args)...);
+        }
+        return back();
+    }
+
+    void pop_back() {
+        std::apply([](auto&... col) { (col.pop_back(), ...); }, m_columns);
+    }
+
+    /**
+     * 删除第i行, 后面的行整体前移
+     * @param i
+     */
+    void erase(size_t i) {
+        std::apply([i](auto&... col) { (col.erase(i), ...); }, m_columns);
+    }
+
+    void resize(size_t n) {
+        reserve(n);
+        std::apply([n](auto&... col) { (col.resize(n), ...); }, m_columns);
+    }
+
+    void clear() {
+        std::apply([](auto&... col) { (col.clear(), ...); }, m_columns);
+    }
+
+    void shrink_to_fit() {
+        std::apply([](auto&... col) { (col.shrink_to_fit(), ...); }, m_columns);
+    }
+
+    void swap(SoaVectors& that) noexcept {
+        m_columns.swap(that.m_columns);
+    }
+
+    reference operator[](size_t i) {
+        return M_row(i, std::index_sequence_for<Fields...>{});
+    }
+
+    const_reference operator[](size_t i) const {
+        return M_row(i, std::index_sequence_for<Fields...>{});
+    }
+
+    reference at(size_t i) {
+        if (i >= size()) throw std::out_of_range("vector::at");
+        return (*this)[i];
+    }
+
+    [[nodiscard]] const_reference at(size_t i) const {
+        if (i >= size()) throw std::out_of_range("vector::at");
+        return (*this)[i];
+    }
+
+    reference front() {
+        return at(0);
+    }
+
+    reference back() {
+        return at(size() - 1);
+    }
+
+    [[nodiscard]] const_reference front() const {
+        return at(0);
+    }
+
+    [[nodiscard]] const_reference back() const {
+        return at(size() - 1);
+    }
+
+    /**
+     * 第I列的连续存储, 用于按列的向量化循环, 例如@code{kernels::sum(col.data(), col.size())}
+     * @tparam I
+     * @return
+     */
+    template<size_t I>
+    std::span<column_type<I>> column() noexcept {
+        auto& col = std::get<I>(m_columns);
+        return {col.data(), col.size()};
+    }
+
+    template<size_t I>
+    [[nodiscard]] std::span<column_type<I> const> column() const noexcept {
+        auto const& col = std::get<I>(m_columns);
+        return {col.data(), col.size()};
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size());
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    [[nodiscard]] const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    [[nodiscard]] const_iterator cend() const noexcept {
+        return end();
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return std::get<0>(m_columns).size();
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept {
+        return std::get<0>(m_columns).capacity();
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return size() == 0;
+    }
+
+private:
+    template<size_t ...I>
+    reference M_row(size_t i, std::index_sequence<I...>) {
+        return reference(std::get<I>(m_columns)[i]...);
+    }
+
+    template<size_t ...I>
+    const_reference M_row(size_t i, std::index_sequence<I...>) const {
+        return const_reference(std::get<I>(m_columns)[i]...);
+    }
+
+    /**
+     * 按列顺序追加, 记录已经成功的列数, 异常时把这些列pop_back
+     * 调用前容量已经足够, 各列的emplace_back不会搬迁
+     */
+    template<size_t ...I, class ...Args>
+    void M_emplace_columns(std::index_sequence<I...>, Args &&... args) {
+        size_t done = 0;
+        try {
+            ((std::get<I>(m_columns).emplace_back(std::forward<Args>(args)), ++done), ...);
+        } catch (...) {
+            ((I < done ? std::get<I>(m_columns).pop_back() : void()), ...);
+            throw;
+        }
+    }
+};
@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cassert>
+#include <string>
+#include <iostream>
+
+#include "soaVectors.hpp"
+#include "kernels.hpp"
+
+struct Particle {
+    float x, y, z;
+    float vx, vy, vz;
+    int id;
+};
+
+int main() {
+    /* 行访问, 结构化绑定与整行赋值 */
+    {
+        SoaVectors<int, std::string> rows = {{1, "one"}, {2, "two"}};
+        rows.push_back({3, "three"});
+        rows.emplace_back(4, "four");
+        auto [id, name] = rows[1];
+        id = 20;
+        name += "!";
+        rows[0] = std::tuple(10, "ten");
+        assert(rows.size() == 4 && rows.capacity() == 4);
+        assert(std::get<0>(rows[1]) == 20 && std::get<1>(rows.at(1)) == "two!");
+        assert(std::get<1>(rows.front()) == "ten" && std::get<0>(rows.back()) == 4);
+
+        /* 参数引用已有元素, 扩容时依然有效 */
+        rows.emplace_back(std::get<0>(rows[0]), std::get<1>(rows[0]));
+        assert(rows.size() == 5 && rows.capacity() == 8 && std::get<1>(rows[4]) == "ten");
+
+        rows.erase(0);
+        rows.pop_back();
+        for (auto [i, s]: rows) {
+            std::cout << i << ": " << s << std::endl;
+        }
+        assert(rows.size() == 3 && std::get<1>(rows[0]) == "two!");
+
+        bool thrown = false;
+        try {
+            rows.at(3);
+        } catch (std::out_of_range const&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 列在同一次reserve中一起扩容 */
+    {
+        SoaVectors<double, char, long> cols;
+        cols.reserve(100);
+        for (int i = 0; i < 1000; i++) {
+            cols.emplace_back(i * 0.5, 'a' + i % 26, i);
+            assert(cols.column<0>().size() == cols.column<1>().size());
+        }
+        assert(cols.capacity() == 1600);
+        assert(kernels::sum(cols.column<2>().data(), cols.size()) == 499500);
+        cols.resize(10);
+        assert(cols.size() == 10 && cols.column<1>()[9] == 'j');
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 只读取一个字段时, SoA只需要扫描这一列 */
+    {
+        constexpr size_t n = 1 << 22;
+        Vectors<Particle> aos;
+        SoaVectors<float, float, float, float, float, float, int> soa;
+        aos.reserve(n);
+        soa.reserve(n);
+        for (size_t i = 0; i < n; i++) {
+            float f = static_cast<float>(i % 1000);
+            aos.push_back({f, f, f, f, f, f, static_cast<int>(i)});
+            soa.emplace_back(f, f, f, f, f, f, static_cast<int>(i));
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        double aos_sum = 0;
+        for (auto const& p: aos) {
+            aos_sum += p.x;
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        double soa_sum = 0;
+        for (float x: soa.column<0>()) {
+            soa_sum += x;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        assert(aos_sum == soa_sum);
+        std::cout << "sum of x, AoS: " << std::chrono::duration<double, std::milli>(mid - start).count() << " ms, "
+                  << "SoA: " << std::chrono::duration<double, std::milli>(end - mid).count() << " ms" << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+    return 0;
+}
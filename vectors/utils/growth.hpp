@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <concepts>
+
+/**
+ * @code{Vectors}的增长策略: 容量不足时, 根据当前容量capacity和至少需要的元素个数required给出新的容量
+ * 策略是一个可调用对象, 接受@code{(size_t capacity, size_t required, size_t elem_size)}
+ * 或者@code{(size_t capacity, size_t required)}; 返回值小于required时按required分配
+ * 例如: @code{Vectors<int, std::allocator<int>, FixedStepGrowth<4096>>}
+ */
+template<class P>
+concept GrowthPolicy = std::invocable<P const&, size_t, size_t, size_t> || std::invocable<P const&, size_t, size_t>;
+
+/**
+ * 按Num/Den倍增长
+ */
+template<size_t Num, size_t Den = 1>
+struct GeometricGrowth {
+    static_assert(Num > Den, "growth factor must be greater than 1");
+
+    [[nodiscard]] constexpr size_t operator()(size_t capacity, size_t required, size_t) const noexcept {
+        return std::max(required, capacity / Den * Num + capacity % Den * Num / Den);
+    }
+};
+
+/** 默认策略, 与std::vector(libstdc++)相同 */
+using DoublingGrowth = GeometricGrowth<2>;
+
+/** 最多浪费1/3的内存, 释放的旧内存之和有机会被后续的分配重用 */
+using OneAndHalfGrowth = GeometricGrowth<3, 2>;
+
+/**
+ * 每次增加固定的Step个元素, 内存浪费有上界, 但追加n个元素需要O(n / Step)次搬迁
+ */
+template<size_t Step>
+struct FixedStepGrowth {
+    static_assert(Step > 0);
+
+    [[nodiscard]] constexpr size_t operator()(size_t capacity, size_t required, size_t) const noexcept {
+        return std::max(required, capacity + Step);
+    }
+};
+
+/**
+ * 在Base的基础上把分配的字节数向上取整到PageSize, 多出来的部分本来就会被分配器浪费掉
+ * 适合与@code{MmapAllocator}一起使用
+ */
+template<class Base = DoublingGrowth, size_t PageSize = 4096>
+struct PageRoundedGrowth {
+    [[no_unique_address]] Base base;
+
+    [[nodiscard]] constexpr size_t operator()(size_t capacity, size_t required, size_t elem_size) const noexcept {
+        size_t n = std::max(required, base(capacity, required, elem_size));
+        size_t bytes = (n * elem_size + PageSize - 1) / PageSize * PageSize;
+        return bytes / elem_size;
+    }
+};
+
+/**
+ * 包装一个增长策略, 记录向量每次改变容量的情况
+ * 通过@code{vec.growth_policy()}读取, 每个向量有自己的一份
+ * 策略中有@code{on_relocate(old_capacity, new_capacity, size, bytes, in_place)}成员时, @code{Vectors}会在容量改变后调用它,
+ * size是这次操作完成后的元素个数, bytes是搬迁的字节数, in_place表示由分配器扩容而没有搬迁元素
+ */
+template<GrowthPolicy Policy = DoublingGrowth>
+struct GrowthStats : Policy {
+    /** 容量改变的次数, 包括原地扩大和shrink_to_fit */
+    size_t reallocations = 0;
+    /** 其中不需要搬迁元素的次数(分配器的try_expand/reallocate) */
+    size_t in_place = 0;
+    /** 搬迁元素的总字节数 */
+    size_t bytes_relocated = 0;
+    size_t peak_capacity = 0;
+    /** 容量改变后没有使用的最大元素个数 */
+    size_t peak_slack = 0;
+
+    constexpr void on_relocate(size_t, size_t new_capacity, size_t size, size_t bytes, bool moved_in_place) noexcept {
+        reallocations += 1;
+        in_place += moved_in_place;
+        bytes_relocated += bytes;
+        peak_capacity = std::max(peak_capacity, new_capacity);
+        peak_slack = std::max(peak_slack, new_capacity - size);
+    }
+
+    constexpr void reset() noexcept {
+        reallocations = in_place = bytes_relocated = peak_capacity = peak_slack = 0;
+    }
+};
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <concepts>
+#include <type_traits>
+
+/**
+ * 标记类型T是否可以"按位搬迁"(trivially relocatable):
+ * 即 move构造到新地址 + 析构旧对象 等价于一次memcpy
+ * 默认只对trivially copyable的类型成立, 其他类型可以通过特化选择加入:
+ * @code{template<> struct is_trivially_relocatable<MyType> : std::true_type {};}
+ * @tparam T
+ */
+template<class T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template<class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<std::remove_cv_t<T>>::value;
+
+/**
+ * 将[first, first + n)的元素搬迁到未初始化的dest, 两个区间不能重叠
+ * 搬迁完成后源区间视为未初始化的内存
+ * 常量求值中不能使用memcpy/memmove, 以下函数在常量求值中都退化为逐个move构造 + 析构
+ * @tparam T
+ * @param first
+ * @param n
+ * @param dest
+ */
+template<class T>
+constexpr void uninitialized_relocate_n(T* first, size_t n, T* dest) {
+    if (is_trivially_relocatable_v<T> && !std::is_constant_evaluated()) {
+        if (n != 0) std::memcpy(static_cast<void *>(dest), static_cast<void const *>(first), n * sizeof(T));
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            std::construct_at(&dest[i], std::move(first[i]));
+            std::destroy_at(&first[i]);
+        }
+    }
+}
+
+/**
+ * 在同一块内存中将[first, first + n)搬迁到dest, 两个区间可以重叠
+ * 用于insert时腾出空位, 以及erase时压缩尾部
+ * @tparam T
+ * @param first
+ * @param n
+ * @param dest
+ */
+template<class T>
+constexpr void relocate_overlapping(T* first, size_t n, T* dest) {
+    if (n == 0 || first == dest) return;
+    if (is_trivially_relocatable_v<T> && !std::is_constant_evaluated()) {
+        std::memmove(static_cast<void *>(dest), static_cast<void const *>(first), n * sizeof(T));
+    } else if (dest < first) {
+        /* 往前搬: 从头开始, 避免覆盖还没搬走的元素 */
+        for (size_t i = 0; i < n; i++) {
+            std::construct_at(&dest[i], std::move(first[i]));
+            std::destroy_at(&first[i]);
+        }
+    } else {
+        /* 往后搬: 从尾部开始 */
+        for (size_t i = n; i > 0; i--) {
+            std::construct_at(&dest[i - 1], std::move(first[i - 1]));
+            std::destroy_at(&first[i - 1]);
+        }
+    }
+}
+
+/**
+ * 把[first, first + n)逐个拷贝到未初始化的dest, 源区间保持不变
+ * 中途抛出异常时析构已经构造好的元素
+ * @tparam T
+ * @param first
+ * @param n
+ * @param dest
+ */
+template<class T>
+constexpr void uninitialized_copy_strong(T const* first, size_t n, T* dest) {
+    size_t i = 0;
+    try {
+        for (; i < n; i++) {
+            std::construct_at(&dest[i], first[i]);
+        }
+    } catch (...) {
+        std::destroy_n(dest, i);
+        throw;
+    }
+}
+
+/**
+ * 将[first, first + n)搬迁到不重叠的未初始化内存dest, 并在下标j处留出gap个位置, 提供强异常安全保证:
+ * 1. 按位搬迁或者move构造不会抛出异常时, 直接move(等价于@code{std::move_if_noexcept})
+ * 2. 否则先把[0, j)和[j, n)两段都拷贝过去, 任何一次拷贝抛出异常时析构dest中已经构造好的元素,
+ *    源区间保持不变; 两段全部成功后才析构源区间的元素
+ * dest[j, j + gap)不被访问, 调用者可以事先在那里构造新元素
+ * @tparam T
+ * @param first
+ * @param n
+ * @param dest
+ * @param j
+ * @param gap
+ */
+template<class T>
+constexpr void uninitialized_relocate_gap_if_noexcept(T* first, size_t n, T* dest, size_t j, size_t gap) {
+    if constexpr (is_trivially_relocatable_v<T>
+                  || std::is_nothrow_move_constructible_v<T>
+                  || !std::is_copy_constructible_v<T>) {
+        uninitialized_relocate_n(first, j, dest);
+        uninitialized_relocate_n(first + j, n - j, dest + j + gap);
+    } else {
+        uninitialized_copy_strong(first, j, dest);
+        try {
+            uninitialized_copy_strong(first + j, n - j, dest + j + gap);
+        } catch (...) {
+            std::destroy_n(dest, j);
+            throw;
+        }
+        std::destroy_n(first, n);
+    }
+}
+
+/**
+ * 不留空位的@code{uninitialized_relocate_gap_if_noexcept}
+ * @tparam T
+ * @param first
+ * @param n
+ * @param dest
+ */
+template<class T>
+constexpr void uninitialized_relocate_if_noexcept(T* first, size_t n, T* dest) {
+    uninitialized_relocate_gap_if_noexcept(first, n, dest, n, 0);
+}
+
+/**
+ * gap[0, n)已经腾出(未初始化), 紧接着是搬走的tail个元素; 用construct(p)逐个构造gap中的元素
+ * 中途抛出异常时析构已经构造的元素并把尾部搬回gap处, 区间恢复为插入之前的样子
+ * 调用者在全部成功之后才把n计入元素个数
+ * @tparam T
+ * @tparam Construct
+ * @param gap
+ * @param n
+ * @param tail
+ * @param construct
+ */
+template<class T, class Construct>
+constexpr void uninitialized_fill_gap(T* gap, size_t n, size_t tail, Construct&& construct) {
+    size_t done = 0;
+    try {
+        for (; done < n; done++) {
+            construct(gap + done);
+        }
+    } catch (...) {
+        std::destroy_n(gap, done);
+        relocate_overlapping(gap + n, tail, gap);
+        throw;
+    }
+}
+
+/**
+ * 向alloc申请容量为n的新内存, 把[first, first + size)搬过去, 并在下标j处留出gap个未初始化的位置
+ * 抛出异常时新内存被释放, 原来的元素不受影响; 旧内存由调用者释放
+ * Vectors与SmallVectors扩容时共用
+ * @return 新内存
+ */
+template<class Alloc, class T>
+constexpr T* allocate_relocate_gap(Alloc& alloc, size_t n, T* first, size_t size, size_t j, size_t gap) {
+    T* new_data = alloc.allocate(n);
+    try {
+        uninitialized_relocate_gap_if_noexcept(first, size, new_data, j, gap);
+    } catch (...) {
+        alloc.deallocate(new_data, n);
+        throw;
+    }
+    return new_data;
+}
+
+/**
+ * 与@code{allocate_relocate_gap}相同, 但先在新内存的下标j处用args构造新元素, 再搬迁旧元素,
+ * 这样args引用旧元素时依然有效
+ * @return 新内存
+ */
+template<class Alloc, class T, class ...Args>
+constexpr T* allocate_relocate_emplace(Alloc& alloc, size_t n, T* first, size_t size, size_t j, Args &&... args) {
+    T* new_data = alloc.allocate(n);
+    try {
+        std::construct_at(&new_data[j], std::forward<Args>(args)...);
+    } catch (...) {
+        alloc.deallocate(new_data, n);
+        throw;
+    }
+    try {
+        uninitialized_relocate_gap_if_noexcept(first, size, new_data, j, 1);
+    } catch (...) {
+        std::destroy_at(&new_data[j]);
+        alloc.deallocate(new_data, n);
+        throw;
+    }
+    return new_data;
+}
+
+/**
+ * 可选的分配器扩展: 尝试在原地把[p, p + old_n)扩大到new_n个元素, 成功返回true
+ * 成功时元素的地址不变, 不需要任何搬迁
+ */
+template<class Alloc, class T>
+concept ExpandableAllocator = requires(Alloc& alloc, T* p, size_t n) {
+    { alloc.try_expand(p, n, n) } -> std::convertible_to<bool>;
+};
+
+/**
+ * 可选的分配器扩展: 类似realloc/mremap, 把内存块扩大到new_n个元素, 必要时换一个地址,
+ * 失败返回nullptr且原来的块保持不变. 内容按字节搬迁, 因此只对trivially relocatable的类型使用
+ */
+template<class Alloc, class T>
+concept ReallocatableAllocator = requires(Alloc& alloc, T* p, size_t n) {
+    { alloc.reallocate(p, n, n) } -> std::same_as<T*>;
+};
+
+/**
+ * 两个分配器是否可以互相释放对方申请的内存; is_always_equal时不需要operator==
+ */
+template<class Alloc>
+constexpr bool allocators_equal(Alloc const& a, Alloc const& b) noexcept {
+    if constexpr (std::allocator_traits<Alloc>::is_always_equal::value) {
+        return true;
+    } else {
+        return a == b;
+    }
+}
+
+/**
+ * 分配器返回的内存保证的对齐字节数: 分配器有静态成员alignment时取它, 否则只保证alignof(T)
+ */
+template<class Alloc, class T>
+inline constexpr size_t allocator_alignment_v = [] {
+    if constexpr (requires { { Alloc::alignment } -> std::convertible_to<size_t>; }) {
+        return std::max<size_t>(Alloc::alignment, alignof(T));
+    } else {
+        return alignof(T);
+    }
+}();
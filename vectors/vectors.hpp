@@ -1,26 +1,59 @@
 #pragma once
 
+#include <array>
 #include <vector>
 #include <iostream>
 #include <cstring>
 #include <memory>
+#include <span>
 #include <utility>
+#include <stdexcept>
 #include <initializer_list>
 
-template<class T, class Alloc = std::allocator<T>>
+#include "utils/relocate.hpp"
+#include "utils/growth.hpp"
+
+/**
+ * 构造或者resize时只做默认初始化的标记: 对int等trivial类型不会清零,
+ * 用于接下来马上会被read()/memcpy覆盖的缓冲区
+ */
+struct default_init_t {
+    explicit default_init_t() = default;
+};
+inline constexpr default_init_t default_init{};
+
+/**
+ * @tparam T
+ * @tparam Alloc
+ * @tparam Growth 容量不足时如何选择新的容量, 见utils/growth.hpp
+ */
+template<class T, class Alloc = std::allocator<T>, GrowthPolicy Growth = DoublingGrowth>
 class Vectors {
 private:
     [[no_unique_address]] Alloc allocator;
+    [[no_unique_address]] Growth m_growth;
 
     T* m_data;
     size_t m_size;
     size_t m_capacity;
 
 public:
-    Vectors() : m_data(nullptr), m_size(0), m_capacity(0){};
+    using value_type = T;
+
+    /** data()的对齐字节数, 由分配器决定, 例如@code{AlignedAllocator}保证64字节 */
+    static constexpr size_t alignment = allocator_alignment_v<Alloc, T>;
+
+    constexpr Vectors() : m_data(nullptr), m_size(0), m_capacity(0){};
+
+    /**
+     * 使用指定的分配器实例, 例如指向某个arena的@code{PolymorphicAllocator}
+     * @param alloc
+     */
+    constexpr explicit Vectors(Alloc const& alloc, Growth const& growth = Growth()) noexcept
+    : allocator(alloc), m_growth(growth), m_data(nullptr), m_size(0), m_capacity(0){};
 
-    explicit Vectors(size_t size) {
-        m_data = allocator.allocate(size);
+    constexpr explicit Vectors(size_t size) {
+        m_data = size == 0 ? nullptr : allocator.allocate(size);
         m_size = size;
         m_capacity = size;
         for (size_t i = 0; i < m_size; i++) {
@@ -28,8 +61,18 @@ public:
         }
     }
 
-    explicit Vectors(size_t size, T const& val) {
-        m_data = allocator.allocate(size);
+    /**
+     * 默认初始化size个元素, trivial类型的内容是未定义的
+     * @param size
+     */
+    constexpr Vectors(size_t size, default_init_t) {
+        m_data = size == 0 ? nullptr : allocator.allocate(size);
+        m_capacity = m_size = size;
+        S_default_construct(m_data, size);
+    }
+
+    constexpr explicit Vectors(size_t size, T const& val) {
+        m_data = size == 0 ? nullptr : allocator.allocate(size);
         m_capacity = m_size = size;
         for (size_t i = 0; i < size; i++) {
             std::construct_at(&m_data[i], val);
@@ -40,7 +83,7 @@ public:
      * 调用@code{explicit Vectors(InputIt first, InputIt last)}
      * @param list
      */
-    Vectors(std::initializer_list<T> list) : Vectors(list.begin(), list.end()){};
+    constexpr Vectors(std::initializer_list<T> list) : Vectors(list.begin(), list.end()){};
 
     /**
      * 确保传入的参数是iterator类型
@@ -49,13 +92,13 @@ public:
      * @param last
      */
     template<std::random_access_iterator InputIt>
-    explicit Vectors(InputIt first, InputIt last) {
+    constexpr explicit Vectors(InputIt first, InputIt last) {
         size_t n = last - first;
-        m_data = allocator.allocate(n);
+        m_data = n == 0 ? nullptr : allocator.allocate(n);
 
         m_capacity = m_size = n;
         for (size_t i = 0; i < n; i++) {
-            m_data[i] = *first;
+            std::construct_at(&m_data[i], *first);
             first++;
         }
     }
@@ -64,33 +107,36 @@ public:
      * 深拷贝防止析构m_data两次
      * @param that
      */
-    Vectors(Vectors const& that) {
-        m_capacity = m_size = that.m_size;
-        if (m_capacity != 0) {
-            m_data = allocator.allocate(m_size);
-            for (size_t i = 0; i < m_size; i++) {
-                std::construct_at(&m_data[i], std::as_const(that.m_data[i]));
-            }
-        } else {
-            m_data = nullptr;
+    constexpr Vectors(Vectors const& that)
+    : Vectors(that, std::allocator_traits<Alloc>::select_on_container_copy_construction(that.allocator)) {};
+
+    /**
+     * 使用指定的分配器深拷贝; 委托构造完成后对象已经存在, 拷贝中途抛出异常时由析构函数回收
+     * @param that
+     * @param alloc
+     */
+    constexpr Vectors(Vectors const& that, Alloc const& alloc) : Vectors(alloc, that.m_growth) {
+        if (that.m_size == 0) return;
+        m_data = allocator.allocate(that.m_size);
+        m_capacity = that.m_size;
+        for (; m_size < that.m_size; m_size++) {
+            std::construct_at(&m_data[m_size], std::as_const(that.m_data[m_size]));
         }
     }
 
     /**
      * 确保拷贝的对象的capacity也被传入当前的对象
+     * 分配器只在propagate_on_container_copy_assignment为true时跟着拷贝, 否则新的存储仍然由当前的分配器申请
      * @param that
      * @return
      */
-    Vectors& operator=(Vectors const& that) {
+    constexpr Vectors& operator=(Vectors const& that) {
         if (this == &that) return *this;
 
-        m_capacity = m_size = that.m_size;
-        if (m_capacity != 0) {
-            m_data = allocator.allocate(m_size);
-            for (size_t i = 0; i < m_size; i++) {
-                std::construct_at(&m_data[i], std::as_const(that.m_data[i]));
-            }
-        }
+        // 先拷贝再交换, 拷贝失败时当前对象保持不变; 原本的元素由tmp析构
+        constexpr bool propagate = std::allocator_traits<Alloc>::propagate_on_container_copy_assignment::value;
+        Vectors tmp(that, propagate ? that.allocator : allocator);
+        swap(tmp);
         return *this;
     }
 
@@ -98,10 +144,7 @@ public:
      * 确保移动构造后原本的对象被析构
      * @param that
      */
-    Vectors(Vectors&& that) noexcept {
-        // 如果移动赋值的目的地对象已经有元素了, 删除原本的元素
-        if (m_capacity != 0) allocator.deallocate(m_data, m_capacity);
-
+    constexpr Vectors(Vectors&& that) noexcept : allocator(std::move(that.allocator)), m_growth(std::move(that.m_growth)) {
         m_data = that.m_data;
         m_size = that.m_size;
         m_capacity = that.m_capacity;
@@ -111,16 +154,47 @@ public:
         that.m_capacity = 0;
     }
 
+    /**
+     * 使用指定的分配器移动构造; 与that的分配器不相等时不能接管对方的内存, 只能逐个move元素
+     * @param that
+     * @param alloc
+     */
+    constexpr Vectors(Vectors&& that, Alloc const& alloc) : Vectors(alloc, that.m_growth) {
+        if (allocators_equal(allocator, that.allocator)) {
+            std::swap(m_data, that.m_data);
+            std::swap(m_size, that.m_size);
+            std::swap(m_capacity, that.m_capacity);
+            return;
+        }
+        if (that.m_size == 0) return;
+        m_data = allocator.allocate(that.m_size);
+        m_capacity = that.m_size;
+        for (; m_size < that.m_size; m_size++) {
+            std::construct_at(&m_data[m_size], std::move(that.m_data[m_size]));
+        }
+    }
+
     /**
      * 确保移动构造后原本的对象被析构
+     * propagate_on_container_move_assignment为false时保留当前的分配器, 分配器不相等时逐个move元素
      * @param that
      * @return
      */
-    Vectors& operator=(Vectors&& that) noexcept {
+    constexpr Vectors& operator=(Vectors&& that)
+    noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value
+             || std::allocator_traits<Alloc>::is_always_equal::value) {
         if (this == &that) return *this;
+        if constexpr (!std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value) {
+            Vectors tmp(std::move(that), allocator);
+            swap(tmp);
+            return *this;
+        }
         // 如果移动赋值的目的地对象已经有元素了, 删除原本的元素
-        if (m_capacity != 0) allocator.deallocate(m_data, m_capacity);
+        M_release();
 
+        // 内存跟着分配器一起转移, 之后由that的分配器负责释放
+        allocator = that.allocator;
+        m_growth = that.m_growth;
         m_data = that.m_data;
         m_size = that.m_size;
         m_capacity = that.m_capacity;
@@ -138,7 +212,7 @@ public:
      * @param last
      */
     template<std::random_access_iterator InputIt>
-    void assign(InputIt first, InputIt last) {
+    constexpr void assign(InputIt first, InputIt last) {
         clear();
         size_t n = last - first;
         reserve(n);
@@ -155,7 +229,7 @@ public:
      * @param first
      * @param last
      */
-    void assign(size_t n, T const& val) {
+    constexpr void assign(size_t n, T const& val) {
         clear();
         reserve(n);
         m_size = n;
@@ -168,24 +242,17 @@ public:
      * 转发给对应函数
      * @param list
      */
-    void assign(std::initializer_list<T> list) {
+    constexpr void assign(std::initializer_list<T> list) {
         assign(list.begin(), list.end());
     }
 
     template<std::random_access_iterator InputIt>
-    T* insert(T const* it, InputIt first, InputIt last) {
+    constexpr T* insert(T const* it, InputIt first, InputIt last) {
         size_t n = last - first, j = it - m_data;
         if (n == 0) return const_cast<T *> (it);
-        reserve(m_size + n);
-        for (size_t i = m_size; i > j; i--) {
-            std::construct_at(&m_data[i + n - 1], std::move(m_data[i - 1]));
-            std::destroy_at(&m_data[i - 1]);
-        }
+        M_open_gap(j, n);
+        uninitialized_fill_gap(m_data + j, n, m_size - j, [&](T* p) { std::construct_at(p, *first); ++first; });
         m_size += n;
-        for (size_t i = j; i < j + n; i++) {
-            std::construct_at(&m_data[i], *first);
-            first++;
-        }
         return m_data + j;
     }
 
@@ -195,28 +262,29 @@ public:
      * @param val
      * @return
      */
-    T* insert(T const* it, T const& val) {
+    constexpr T* insert(T const* it, T const& val) {
         size_t j = it - m_data;
-        reserve(m_size + 1);
-        for (size_t i = m_size; i > j; i--) {
-            std::construct_at(&m_data[i], std::move(m_data[i - 1]));
-            std::destroy_at(&m_data[i - 1]);
+        if (m_size + 1 > m_capacity) {
+            M_realloc_emplace(j, val);
+            return m_data + j;
         }
+        // val可能引用的是本向量中的元素, 先拷贝出来再移动尾部
+        T tmp(val);
+        relocate_overlapping(m_data + j, m_size - j, m_data + j + 1);
+        std::construct_at(&m_data[j], std::move(tmp));
         m_size += 1;
-        std::construct_at(&m_data[j], val);
         return m_data + j;
     }
 
-    T* insert(T const* it, T&& val) {
+    constexpr T* insert(T const* it, T&& val) {
         size_t j = it - m_data;
-        reserve(m_size + 1);
-        for (size_t i = m_size; i > j; i--) {
-            std::construct_at(&m_data[i], std::move(m_data[i - 1]));
-            std::destroy_at(&m_data[i - 1]);
+        if (m_size + 1 > m_capacity) {
+            M_realloc_emplace(j, std::move(val));
+            return m_data + j;
         }
-        m_size += 1;
+        relocate_overlapping(m_data + j, m_size - j, m_data + j + 1);
         std::construct_at(&m_data[j], std::move(val));
-
+        m_size += 1;
         return m_data + j;
     }
 
@@ -227,20 +295,14 @@ public:
      * @param val
      * @return
      */
-    T* insert(T const* it, size_t n, T const& val) {
+    constexpr T* insert(T const* it, size_t n, T const& val) {
         size_t j = it - m_data;
         if (n == 0) return const_cast<T *> (it);
-        reserve(m_size + n);
-        /* 将当前iterator之后的元素往后移n位 */
-        for (size_t i = m_size; i > j; i--) {
-            std::construct_at(&m_data[i + n - 1], std::move(m_data[i - 1]));
-            std::destroy_at(&m_data[i - 1]);
-        }
+        T tmp(val);
+        /* 将当前iterator之后的元素往后移n位, 构造全部成功之后才计入m_size */
+        M_open_gap(j, n);
+        uninitialized_fill_gap(m_data + j, n, m_size - j, [&](T* p) { std::construct_at(p, std::as_const(tmp)); });
         m_size += n;
-        /* 给指定的区间元素赋值 */
-        for (size_t i = j; i < j + n; i++) {
-            std::construct_at(&m_data[i], val);
-        }
         return m_data + j;
     }
 
@@ -248,11 +310,13 @@ public:
      * 转发给@code{T* insert(T const* it, InputIt first, InputIt last)}
      * @param list
      */
-    T* insert(T const* it, std::initializer_list<T> list) {
+    constexpr T* insert(T const* it, std::initializer_list<T> list) {
         return insert(it, list.begin(), list.end());
     }
 
-    void swap(Vectors& that) {
+    constexpr void swap(Vectors& that) noexcept {
+        std::swap(allocator, that.allocator);
+        std::swap(m_growth, that.m_growth);
         std::swap(m_data, that.m_data);
         std::swap(m_size, that.m_size);
         std::swap(m_capacity, that.m_capacity);
@@ -262,155 +326,180 @@ public:
      * 需要将m_size置为0
      * m_capacity不需要
      */
-    void clear() {
+    constexpr void clear() {
         for (size_t i = 0; i < m_size; i++) {
             std::destroy_at(&m_data[i]);
         }
         m_size = 0;
     }
 
-    void resize(size_t size) {
+    constexpr void resize(size_t size) {
+        if (size < m_size) {
+            erase(size, m_size);
+            return;
+        }
         reserve(size);
-        if (size > m_size) {
-            for (size_t i = m_size; i < size; i++) {
-                std::construct_at(&m_data[i]);
-            }
+        for (size_t i = m_size; i < size; i++) {
+            std::construct_at(&m_data[i]);
         }
+        m_size = size;
     }
 
-    void resize(size_t size, T const& val) {
+    constexpr void resize(size_t size, T const& val) {
+        if (size < m_size) {
+            erase(size, m_size);
+            return;
+        }
         reserve(size);
-        if (size > m_size) {
-            for (size_t i = m_size; i < size; i++) {
-                std::construct_at(&m_data[i], val);
-            }
+        for (size_t i = m_size; i < size; i++) {
+            std::construct_at(&m_data[i], val);
         }
+        m_size = size;
     }
 
     /**
-     * 将capacity缩小到size
+     * 与resize相同, 但新增的元素只做默认初始化(trivial类型不清零)
+     * 用于随后会被整体覆盖的I/O缓冲区
+     * @param size
      */
-    void shrink_to_fit() {
-        auto old_data = m_data;
-        auto old_capacity = m_capacity;
+    constexpr void resize_for_overwrite(size_t size) {
+        if (size < m_size) {
+            erase(size, m_size);
+            return;
+        }
+        reserve(size);
+        S_default_construct(m_data + m_size, size - m_size);
+        m_size = size;
+    }
 
-        m_capacity = m_size;
-        if (m_size == 0) {
-            m_data = nullptr;
-        } else m_data = allocator.allocate(m_size);
+    /**
+     * 在尾部追加n个默认初始化的元素, 返回这段可写的区间
+     * 例如: @code{auto buf = vec.append_uninitialized(4096); buf = buf.first(read(fd, buf.data(), buf.size_bytes()));}
+     * 调用者读取的字节数不足时需要自己resize回去
+     * @param n
+     * @return
+     */
+    constexpr std::span<T> append_uninitialized(size_t n) {
+        size_t old_size = m_size;
+        resize_for_overwrite(m_size + n);
+        return {m_data + old_size, n};
+    }
 
-        if (old_capacity) {
-            for (size_t i = 0; i < m_size; i++) {
-                std::construct_at(&m_data[i], std::as_const(old_data[i])); // m_data[i] = old_data[i];
-            }
-            allocator.deallocate(old_data, old_capacity);
+    /**
+     * 将capacity缩小到size
+     */
+    constexpr void shrink_to_fit() {
+        if (m_size == m_capacity) return;
+        if (m_size == 0) {
+            M_release();
+            return;
         }
+        M_reallocate(m_size, m_size, 0);
     }
 
-    void reserve(size_t n) {
+    /**
+     * 分配器支持原地扩容(try_expand)或者重映射(reallocate)时直接扩大当前内存;
+     * 否则元素可以无异常地move时move到新的内存, 否则拷贝
+     * 分配或者拷贝失败时向量保持不变(强异常安全)
+     * @param n
+     */
+    constexpr void reserve(size_t n) {
         if (n <= m_capacity) [[likely]] return;
-        n = std::max(n, m_capacity * 2);
-        auto old_data = m_data;
-        auto old_capacity = m_capacity;
-        if (n == 0) {
-            m_data = nullptr;
-            m_capacity = 0;
-        } else {
-            m_data = allocator.allocate(n);
-            m_capacity = n;
-        }
-        if (old_capacity) {
-            if (m_capacity != 0) {
-                for (size_t i = 0; i < m_size; i++) {
-                    std::construct_at(&m_data[i], std::as_const(old_data[i]));
-                }
-            }
-            allocator.deallocate(old_data, old_capacity);
-        }
+        n = M_recommend(n);
+        if (M_grow_without_copy(n, m_size)) return;
+        M_reallocate(n, m_size, 0);
     }
 
-    [[nodiscard]] T const& at(size_t i) const {
+    [[nodiscard]] constexpr T const& at(size_t i) const {
         if (i >= m_size) throw std::out_of_range("vector::at");
         return m_data[i];
     }
 
-    T& at(size_t i) {
+    constexpr T& at(size_t i) {
         if (i >= m_size) throw std::out_of_range("vector::at");
         return m_data[i];
     }
 
-    [[nodiscard]] T const& front() const {
+    [[nodiscard]] constexpr T const& front() const {
         return at(0);
     }
 
-    T& front() {
+    constexpr T& front() {
         return at(0);
     }
 
-    [[nodiscard]] T const& back() const {
+    [[nodiscard]] constexpr T const& back() const {
         return at(m_size - 1);
     }
 
-    T& back() {
+    constexpr T& back() {
         return at(m_size - 1);
     }
 
-    T* begin() {
+    constexpr T* begin() {
+        return m_data;
+    }
+
+    [[nodiscard]] constexpr T const *begin() const {
         return m_data;
     }
 
-    [[nodiscard]] T const *cbegin() const {
+    [[nodiscard]] constexpr T const *cbegin() const {
         return m_data;
     }
 
-    T* end() {
+    constexpr T* end() {
         return m_data + m_size;
     }
 
-    [[nodiscard]] T const *cend() const {
+    [[nodiscard]] constexpr T const *end() const {
         return m_data + m_size;
     }
 
-    std::reverse_iterator<T *> rbegin() {
-        return std::make_reverse_iterator(m_data);
+    [[nodiscard]] constexpr T const *cend() const {
+        return m_data + m_size;
     }
 
-    std::reverse_iterator<T *> rend() {
+    constexpr std::reverse_iterator<T *> rbegin() {
         return std::make_reverse_iterator(m_data + m_size);
     }
 
-    [[nodiscard]] std::reverse_iterator<T const*> rbegin() const {
+    constexpr std::reverse_iterator<T *> rend() {
         return std::make_reverse_iterator(m_data);
     }
 
-    [[nodiscard]] std::reverse_iterator<T const*> rend() const {
-        return std::make_reverse_iterator(m_data + m_size);
+    [[nodiscard]] constexpr std::reverse_iterator<T const*> rbegin() const {
+        return std::make_reverse_iterator(cend());
     }
 
-    [[nodiscard]] std::reverse_iterator<T const*> crbegin() const {
-        return std::make_reverse_iterator(m_data);
+    [[nodiscard]] constexpr std::reverse_iterator<T const*> rend() const {
+        return std::make_reverse_iterator(cbegin());
     }
 
-    [[nodiscard]] std::reverse_iterator<T const*> crend() const {
-        return std::make_reverse_iterator(m_data + m_size);
+    [[nodiscard]] constexpr std::reverse_iterator<T const*> crbegin() const {
+        return rbegin();
     }
 
+    [[nodiscard]] constexpr std::reverse_iterator<T const*> crend() const {
+        return rend();
+    }
 
-    void push_back(T const& val) {
-        if(m_size + 1 > m_capacity) reserve(m_size + 1);
-        std::construct_at(&m_data[m_size], val);
-        m_size += 1;
+
+    constexpr void push_back(T const& val) {
+        emplace_back(val);
     }
 
-    void push_back(T &&val) {
-        if(m_size + 1 > m_capacity) reserve(m_size + 1);
-        std::construct_at(&m_data[m_size], std::move(val));
-        m_size += 1;
+    constexpr void push_back(T &&val) {
+        emplace_back(std::move(val));
     }
 
     template<class ...Args>
-    T& emplace_back(Args &&... args) {
-        if(m_size + 1 > m_capacity) reserve(m_size + 1);
+    constexpr T& emplace_back(Args &&... args) {
+        if (m_size + 1 > m_capacity) [[unlikely]] {
+            // 参数可能引用本向量中的元素, 必须在释放旧内存之前构造
+            M_realloc_emplace(m_size, std::forward<Args>(args)...);
+            return m_data[m_size - 1];
+        }
 
         T *p = &m_data[m_size];
         std::construct_at(&m_data[m_size], std::forward<Args>(args)...);
@@ -418,59 +507,355 @@ public:
         return *p;
     }
 
-    void pop_back() {
+    constexpr void pop_back() {
         m_size -= 1;
         std::destroy_at(&m_data[m_size]);
     }
 
-    void erase(size_t i) {
-        for (size_t j = i + 1; j < m_size; j++) {
-            m_data[j - 1] = std::move(m_data[j]);
-        }
-        resize(m_size - 1);
+    constexpr void erase(size_t i) {
+        erase(i, i + 1);
     }
 
-    void erase(size_t beg, size_t end) {
+    /**
+     * 析构[beg, end)之后把尾部整体搬迁到空出的位置
+     * @param beg
+     * @param end
+     */
+    constexpr void erase(size_t beg, size_t end) {
         size_t diff = end - beg;
-        for (size_t j = end; j < m_size; j++) {
-            m_data[j - diff] = std::move(m_data[j]);
+        if (diff == 0) return;
+        for (size_t j = beg; j < end; j++) {
+            std::destroy_at(&m_data[j]);
         }
-        resize(m_size - diff);
+        relocate_overlapping(m_data + end, m_size - end, m_data + beg);
+        m_size -= diff;
     }
 
-    T* erase(T const* it) {
+    constexpr T* erase(T const* it) {
         size_t i = it - m_data;
-        for (size_t j = i + 1; j < m_size; j++) {
-            m_data[j - 1] = std::move(m_data[j]);
+        erase(i, i + 1);
+        return m_data + i;
+    }
+
+    constexpr T* erase(T const* first, T const* last) {
+        size_t i = first - m_data;
+        erase(i, static_cast<size_t>(last - m_data));
+        return m_data + i;
+    }
+
+    /**
+     * 一次线性扫描删除所有满足pred的元素, 保持其余元素的相对顺序
+     * 被删除的元素就地析构, 相邻的保留元素整段搬迁(trivially relocatable时是一次memmove),
+     * trivially copyable的类型不需要析构, 改为逐个无分支地复制
+     * pred抛出异常时已经删除的元素不会恢复, 其余元素保持有效且连续
+     * @param pred
+     * @return 删除的个数
+     */
+    template<class Pred>
+    constexpr size_t erase_if(Pred pred) {
+        return M_compact([&](T const& x) -> bool { return pred(x); });
+    }
+
+    /**
+     * 只保留满足pred的元素, 等价于erase_if(!pred)
+     */
+    template<class Pred>
+    constexpr size_t retain(Pred pred) {
+        return M_compact([&](T const& x) -> bool { return !pred(x); });
+    }
+
+    /**
+     * 删除所有等于value的元素, value可以引用向量中的元素
+     * @param value
+     * @return 删除的个数
+     */
+    constexpr size_t remove(T const& value) {
+        if (&value >= m_data && &value < m_data + m_size) {
+            T copy(value);
+            return M_compact([&](T const& x) -> bool { return x == copy; });
         }
-        resize(m_size - 1);
-        return const_cast<T *> (it + 1);
+        return M_compact([&](T const& x) -> bool { return x == value; });
     }
 
-    T* erase(T const* first, T const* last) {
-        size_t diff = last - first;
-        for (size_t j = last - m_data; j < m_size; j++) {
-            m_data[j - diff] = std::move(m_data[j]);
+    /**
+     * 删除一组下标对应的元素, indices必须升序排列, 重复的下标只删除一次
+     * 两个下标之间的元素整段搬迁, 不需要逐个判断
+     * @param indices
+     * @return 删除的个数
+     */
+    constexpr size_t erase_indices(std::span<size_t const> indices) {
+        if (indices.empty()) return 0;
+        if (indices.back() >= m_size) throw std::out_of_range("vector::erase_indices");
+        // [w, i)是已经空出来的位置
+        size_t w = 0, i = 0;
+        for (size_t r: indices) {
+            if (r < i) continue;
+            relocate_overlapping(m_data + i, r - i, m_data + w);
+            w += r - i;
+            std::destroy_at(&m_data[r]);
+            i = r + 1;
         }
-        resize(m_size - diff);
-        return const_cast<T *> (last);
+        relocate_overlapping(m_data + i, m_size - i, m_data + w);
+        size_t removed = i - w;
+        m_size -= removed;
+        return removed;
     }
 
-    [[nodiscard]] size_t size() const {
+    [[nodiscard]] constexpr size_t size() const {
         return m_size;
     }
 
-    [[nodiscard]] size_t capacity() const {
+    [[nodiscard]] constexpr size_t capacity() const {
         return m_capacity;
     }
 
-    T const& operator[](size_t i) const {
+    [[nodiscard]] constexpr Alloc get_allocator() const noexcept {
+        return allocator;
+    }
+
+    /**
+     * 当前向量的增长策略对象, 使用@code{GrowthStats}时可以从这里读取统计
+     * @return
+     */
+    [[nodiscard]] constexpr Growth const& growth_policy() const noexcept {
+        return m_growth;
+    }
+
+    constexpr Growth& growth_policy() noexcept {
+        return m_growth;
+    }
+
+    constexpr T* data() noexcept {
+        return m_data;
+    }
+
+    [[nodiscard]] constexpr T const* data() const noexcept {
+        return m_data;
+    }
+
+    constexpr T const& operator[](size_t i) const {
         return m_data[i];
     }
 
-    T& operator[](size_t i) {
+    constexpr T& operator[](size_t i) {
         return m_data[i];
     }
 
-    ~Vectors() { if (m_capacity != 0) allocator.deallocate(m_data, m_capacity); }
+    constexpr ~Vectors() { M_release(); }
+
+private:
+    /**
+     * 计算至少容纳n个元素时应该分配的容量
+     * @param n
+     * @return
+     */
+    [[nodiscard]] constexpr size_t M_recommend(size_t n) const noexcept {
+        size_t res;
+        if constexpr (std::invocable<Growth const&, size_t, size_t, size_t>) {
+            res = m_growth(m_capacity, n, sizeof(T));
+        } else {
+            res = m_growth(m_capacity, n);
+        }
+        return std::max(n, res);
+    }
+
+    /**
+     * 容量从old_capacity变为m_capacity之后通知增长策略, 策略没有on_relocate时什么都不做
+     * @param old_capacity
+     * @param size 这次操作完成后的元素个数
+     * @param bytes 搬迁的字节数
+     * @param in_place 由分配器扩容, 没有搬迁元素
+     */
+    constexpr void M_note_relocate(size_t old_capacity, size_t size, size_t bytes, bool in_place) noexcept {
+        if constexpr (requires { m_growth.on_relocate(old_capacity, m_capacity, size, bytes, in_place); }) {
+            m_growth.on_relocate(old_capacity, m_capacity, size, bytes, in_place);
+        }
+    }
+
+    /**
+     * 析构所有元素并归还内存
+     */
+    constexpr void M_release() noexcept {
+        clear();
+        if (m_capacity != 0) allocator.deallocate(m_data, m_capacity);
+        m_data = nullptr;
+        m_capacity = 0;
+    }
+
+    /**
+     * 搬迁到容量为n的新内存, 并在下标j处留出gap个未初始化的位置
+     * 任何一步抛出异常时新内存被释放, 原来的元素不受影响
+     * @param n
+     * @param j
+     * @param gap
+     */
+    constexpr void M_reallocate(size_t n, size_t j, size_t gap) {
+        T* new_data = allocate_relocate_gap(allocator, n, m_data, m_size, j, gap);
+        if (m_capacity != 0) allocator.deallocate(m_data, m_capacity);
+        size_t old_capacity = m_capacity;
+        m_data = new_data;
+        m_capacity = n;
+        M_note_relocate(old_capacity, m_size + gap, m_size * sizeof(T), false);
+    }
+
+    /**
+     * 在下标j处腾出n个未初始化的位置, 容量不足时直接搬到新内存中对应的位置,
+     * 避免先reserve再整体后移造成的两次搬迁
+     * @param j
+     * @param n
+     */
+    constexpr void M_open_gap(size_t j, size_t n) {
+        if (m_size + n > m_capacity) {
+            size_t new_capacity = M_recommend(m_size + n);
+            if (!M_grow_without_copy(new_capacity, m_size + n)) {
+                M_reallocate(new_capacity, j, n);
+                return;
+            }
+        }
+        relocate_overlapping(m_data + j, m_size - j, m_data + j + n);
+    }
+
+    /**
+     * 通过分配器的扩展接口把容量扩大到n, 不需要把元素搬到新的内存
+     * 1. try_expand: 原地扩大, 地址不变
+     * 2. reallocate: 例如mremap, 由页表完成搬迁, 只适用于trivially relocatable的类型
+     * @param n
+     * @param size 这次操作完成后的元素个数, 只用于统计
+     * @return 分配器不支持或者扩容失败时返回false
+     */
+    constexpr bool M_grow_without_copy(size_t n, size_t size) {
+        if (m_capacity == 0) return false;
+        size_t old_capacity = m_capacity;
+        if constexpr (ExpandableAllocator<Alloc, T>) {
+            if (allocator.try_expand(m_data, m_capacity, n)) {
+                m_capacity = n;
+                M_note_relocate(old_capacity, size, 0, true);
+                return true;
+            }
+        }
+        if constexpr (ReallocatableAllocator<Alloc, T> && is_trivially_relocatable_v<T>) {
+            T* new_data = allocator.reallocate(m_data, m_capacity, n);
+            if (new_data != nullptr) {
+                m_data = new_data;
+                m_capacity = n;
+                M_note_relocate(old_capacity, size, 0, true);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * 容量不足时在下标j处构造新元素: 先在新内存中构造, 再搬迁旧元素,
+     * 这样args引用旧元素时依然有效
+     * @tparam Args
+     * @param j
+     * @param args
+     */
+    template<class ...Args>
+    constexpr void M_realloc_emplace(size_t j, Args &&... args) {
+        size_t n = M_recommend(m_size + 1);
+        if constexpr (ExpandableAllocator<Alloc, T> || ReallocatableAllocator<Alloc, T>) {
+            // 原地扩容或者重映射之后args可能不再有效, 先构造到临时对象中
+            T tmp(std::forward<Args>(args)...);
+            if (M_grow_without_copy(n, m_size + 1)) {
+                relocate_overlapping(m_data + j, m_size - j, m_data + j + 1);
+                std::construct_at(&m_data[j], std::move(tmp));
+                m_size += 1;
+                return;
+            }
+            M_realloc_emplace_new(n, j, std::move(tmp));
+        } else {
+            M_realloc_emplace_new(n, j, std::forward<Args>(args)...);
+        }
+    }
+
+    /**
+     * 在新内存中构造下标j处的元素, 再把旧元素搬过去
+     */
+    template<class ...Args>
+    constexpr void M_realloc_emplace_new(size_t n, size_t j, Args &&... args) {
+        T* new_data = allocate_relocate_emplace(allocator, n, m_data, m_size, j, std::forward<Args>(args)...);
+        if (m_capacity != 0) allocator.deallocate(m_data, m_capacity);
+        size_t old_capacity = m_capacity;
+        m_data = new_data;
+        m_capacity = n;
+        M_note_relocate(old_capacity, m_size + 1, m_size * sizeof(T), false);
+        m_size += 1;
+    }
+
+    /**
+     * 默认初始化n个元素; 常量求值中不能有未初始化的值, 改为值初始化
+     */
+    static constexpr void S_default_construct(T* first, size_t n) {
+        if (std::is_constant_evaluated()) {
+            for (size_t i = 0; i < n; i++) {
+                std::construct_at(&first[i]);
+            }
+            return;
+        }
+        std::uninitialized_default_construct_n(first, n);
+    }
+
+    /**
+     * erase_if/retain/remove的公共部分: removed(x)为true的元素就地析构, 保留的元素按段往前搬迁
+     * removed抛出异常时把还没有检查的部分接到已经压缩好的部分后面
+     * @param removed
+     * @return 删除的个数
+     */
+    template<class Removed>
+    constexpr size_t M_compact(Removed removed) {
+        // 写入元素时编译器无法确定m_data/m_size没有被修改, 先放到局部变量中
+        T* data = m_data;
+        size_t n = m_size, i = 0;
+        while (i < n && !removed(std::as_const(data[i]))) i++;
+        // [w, i)是已经空出来的位置
+        size_t w = i;
+        try {
+            if (std::is_trivially_copyable_v<T> && !std::is_constant_evaluated()) {
+                // 删除不需要析构: 每个元素都无条件写到w, 只有保留时w才前进, 循环中没有分支
+                for (; i < n; i++) {
+                    bool keep = !removed(std::as_const(data[i]));
+                    std::memmove(static_cast<void *>(&data[w]), static_cast<void const *>(&data[i]), sizeof(T));
+                    w += keep;
+                }
+            } else {
+                while (i < n) {
+                    std::destroy_at(&data[i]);
+                    i += 1;
+                    size_t j = i;
+                    while (j < n && !removed(std::as_const(data[j]))) j++;
+                    relocate_overlapping(data + i, j - i, data + w);
+                    w += j - i;
+                    i = j;
+                }
+            }
+        } catch (...) {
+            relocate_overlapping(data + i, n - i, data + w);
+            m_size = n - (i - w);
+            throw;
+        }
+        m_size = w;
+        return n - w;
+    }
 };
+
+/**
+ * 把常量求值中生成的@code{Vectors}固定成@code{std::array}, 用于在编译期生成查找表
+ * gen必须是无捕获的lambda, 会在编译期调用两次: 第一次得到元素个数, 第二次复制元素;
+ * 常量求值中分配的内存不能留到运行期, 所以结果不能直接是@code{Vectors}
+ * 例如: @code{static constexpr auto table = materialize([] { Vectors<uint32_t> v; ...; return v; });}
+ * @tparam Gen
+ * @return
+ */
+template<class Gen>
+consteval auto materialize(Gen) {
+    using Vec = decltype(Gen{}());
+    constexpr size_t n = Gen{}().size();
+    std::array<typename Vec::value_type, n> res{};
+    Vec vec = Gen{}();
+    for (size_t i = 0; i < n; i++) {
+        res[i] = std::move(vec[i]);
+    }
+    return res;
+}
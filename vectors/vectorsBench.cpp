@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "vectors.hpp"
+
+/**
+ * Vectors与std::vector的对比测试, 两边使用同一个计数分配器
+ * 用法: vectorsBench [--max-size N] [--min-ops N] [--mem-budget BYTES] [--json FILE]
+ * 1. --max-size: 元素个数从10开始每次乘10, 直到N(默认10^6, 最大10^8); 超过--mem-budget字节的组合跳过
+ * 2. --min-ops: 每个组合至少执行的操作次数, 元素少时重复多轮, 默认10^7
+ * 3. --json: 把所有结果写成JSON数组, 不同版本的结果可以直接diff
+ * 每个结果包含ns/op, 每轮的分配次数, 以及每轮扩容时从旧内存搬走的字节数(realloc_bytes,
+ * 按被释放的旧内存块大小统计; insert/erase在原内存中的移动不计入)
+ */
+
+struct Counters {
+    size_t allocations = 0;
+    size_t freed_bytes = 0;
+};
+
+inline Counters g_counters;
+
+template<class T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() noexcept = default;
+
+    template<class U>
+    CountingAllocator(CountingAllocator<U> const&) noexcept {};
+
+    T* allocate(size_t n) {
+        g_counters.allocations += 1;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        g_counters.freed_bytes += n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template<class U>
+    bool operator==(CountingAllocator<U> const&) const noexcept {
+        return true;
+    }
+};
+
+/** 64字节的POD, 一条缓存行 */
+struct Pod64 {
+    int64_t key;
+    char payload[56];
+};
+
+/**
+ * 每种元素类型如何从下标构造, 以及迭代时读取什么
+ */
+template<class T>
+struct Elem;
+
+template<>
+struct Elem<int> {
+    static constexpr char const* name = "int";
+
+    static int make(size_t i) {
+        return static_cast<int>(i);
+    }
+
+    template<class Vec>
+    static void emplace(Vec& v, size_t i) {
+        v.emplace_back(static_cast<int>(i));
+    }
+
+    static size_t weight(int x) {
+        return static_cast<size_t>(x);
+    }
+};
+
+template<>
+struct Elem<Pod64> {
+    static constexpr char const* name = "pod64";
+
+    static Pod64 make(size_t i) {
+        Pod64 p{};
+        p.key = static_cast<int64_t>(i);
+        return p;
+    }
+
+    template<class Vec>
+    static void emplace(Vec& v, size_t i) {
+        v.emplace_back(static_cast<int64_t>(i));
+    }
+
+    static size_t weight(Pod64 const& p) {
+        return static_cast<size_t>(p.key);
+    }
+};
+
+template<>
+struct Elem<std::string> {
+    static constexpr char const* name = "string";
+
+    /** 32个字符, 超过SSO的长度, 每个元素都有自己的堆内存 */
+    static std::string make(size_t i) {
+        return std::string(32, static_cast<char>('a' + i % 26));
+    }
+
+    template<class Vec>
+    static void emplace(Vec& v, size_t i) {
+        v.emplace_back(32, static_cast<char>('a' + i % 26));
+    }
+
+    static size_t weight(std::string const& s) {
+        return s.size() + static_cast<unsigned char>(s[0]);
+    }
+};
+
+struct Result {
+    double ns_per_op;
+    double allocations;
+    double realloc_bytes;
+};
+
+/** 防止被优化掉的结果 */
+inline size_t g_sink = 0;
+
+/**
+ * 执行rounds轮, 每轮的初始状态由setup在计时之外准备好; 元素少时一次计时覆盖多轮, 减少读时钟的误差
+ * body把产生的向量留在状态中, 析构发生在计时之后, 也不计入分配统计;
+ * 因此realloc_bytes中只有扩容时释放的旧内存
+ * @return 每次操作的纳秒数, 以及每轮的分配次数和扩容搬迁的字节数
+ */
+template<class Setup, class Body>
+Result measure(size_t n, size_t rounds, Setup setup, Body body) {
+    using State = decltype(setup());
+    size_t batch = std::clamp<size_t>(65536 / std::max<size_t>(n, 1), 1, rounds);
+    double ns = 0;
+    size_t ops = 0, allocations = 0, freed = 0;
+    for (size_t done = 0; done < rounds; done += batch) {
+        size_t count = std::min(batch, rounds - done);
+        std::vector<State> states;
+        states.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            states.push_back(setup());
+        }
+        Counters before = g_counters;
+        auto start = std::chrono::steady_clock::now();
+        for (State& state: states) {
+            ops += body(state);
+        }
+        auto end = std::chrono::steady_clock::now();
+        allocations += g_counters.allocations - before.allocations;
+        freed += g_counters.freed_bytes - before.freed_bytes;
+        ns += std::chrono::duration<double, std::nano>(end - start).count();
+    }
+    return {ns / static_cast<double>(ops), static_cast<double>(allocations) / rounds, static_cast<double>(freed) / rounds};
+}
+
+/**
+ * 每轮的状态: src是操作的对象, dst接收push_back/copy/move的结果
+ */
+template<class Vec>
+struct Slot {
+    Vec src;
+    Vec dst;
+};
+
+template<class Vec>
+Vec build(size_t n) {
+    using T = typename Vec::value_type;
+    Vec v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        v.push_back(Elem<T>::make(i));
+    }
+    return v;
+}
+
+/** 一轮中插入/删除的次数, 每次都是O(n)的移动 */
+inline size_t S_edits(size_t n) {
+    return std::max<size_t>(1, std::min<size_t>(n / 2, 1000));
+}
+
+template<class Vec>
+Result run(std::string const& op, size_t n, size_t rounds) {
+    using T = typename Vec::value_type;
+    auto empty = [] { return Slot<Vec>{}; };
+    auto filled = [n] { return Slot<Vec>{build<Vec>(n), Vec()}; };
+
+    if (op == "push_back" || op == "reserve") {
+        bool reserve = op == "reserve";
+        return measure(n, rounds, empty, [n, reserve](Slot<Vec>& s) {
+            if (reserve) s.dst.reserve(n);
+            for (size_t i = 0; i < n; i++) {
+                s.dst.push_back(Elem<T>::make(i));
+            }
+            return n;
+        });
+    }
+    if (op == "emplace_back") {
+        return measure(n, rounds, empty, [n](Slot<Vec>& s) {
+            for (size_t i = 0; i < n; i++) {
+                Elem<T>::emplace(s.dst, i);
+            }
+            return n;
+        });
+    }
+    if (op == "insert_front" || op == "insert_middle") {
+        bool front = op == "insert_front";
+        return measure(n, rounds, filled, [n, front](Slot<Vec>& s) {
+            size_t edits = S_edits(n);
+            for (size_t i = 0; i < edits; i++) {
+                s.src.insert(s.src.begin() + (front ? 0 : s.src.size() / 2), Elem<T>::make(i));
+            }
+            return edits;
+        });
+    }
+    if (op == "erase") {
+        return measure(n, rounds, filled, [n](Slot<Vec>& s) {
+            size_t edits = S_edits(n);
+            for (size_t i = 0; i < edits; i++) {
+                s.src.erase(s.src.begin() + s.src.size() / 2);
+            }
+            return edits;
+        });
+    }
+    if (op == "copy") {
+        return measure(n, rounds, filled, [n](Slot<Vec>& s) {
+            s.dst = s.src;
+            return n;
+        });
+    }
+    if (op == "move") {
+        // 移动与元素个数无关, 每轮来回移动1000次
+        return measure(n, rounds, filled, [](Slot<Vec>& s) {
+            for (int i = 0; i < 500; i++) {
+                s.dst = std::move(s.src);
+                s.src = std::move(s.dst);
+            }
+            return size_t(1000);
+        });
+    }
+    // iterate
+    return measure(n, rounds, filled, [n](Slot<Vec>& s) {
+        size_t sum = 0;
+        for (auto it = s.src.begin(); it != s.src.end(); ++it) {
+            sum += Elem<T>::weight(*it);
+        }
+        g_sink += sum;
+        return n;
+    });
+}
+
+struct Options {
+    size_t max_size = 1000000;
+    size_t min_ops = 10000000;
+    size_t mem_budget = size_t(2) << 30;
+    std::string json;
+};
+
+struct Record {
+    std::string op;
+    char const* type;
+    size_t size;
+    Result vectors;
+    Result std_vector;
+};
+
+template<class T>
+void bench_type(Options const& opt, std::vector<Record>& records) {
+    // string的堆内存大约再占48字节
+    size_t elem_bytes = sizeof(T) + (std::is_same_v<T, std::string> ? 48 : 0);
+    char const* ops[] = {"push_back", "emplace_back", "reserve", "insert_front", "insert_middle",
+                         "erase", "copy", "move", "iterate"};
+    for (char const* op: ops) {
+        for (size_t n = 10; n <= opt.max_size; n *= 10) {
+            // copy同时存在两份
+            if (n * elem_bytes * 2 > opt.mem_budget) break;
+            bool edits = std::strncmp(op, "insert", 6) == 0 || std::strcmp(op, "erase") == 0;
+            // 每轮的准备工作是建一个n个元素的向量, 轮数同时受准备开销和操作次数的限制
+            size_t per_round = std::strcmp(op, "move") == 0 ? std::max<size_t>(n, 1000) : n;
+            size_t rounds = std::max<size_t>(1, opt.min_ops / per_round);
+            // insert/erase每次都是O(n), 再少跑一些轮
+            if (edits) rounds = std::max<size_t>(1, rounds / 10);
+            Result ours = run<Vectors<T, CountingAllocator<T>>>(op, n, rounds);
+            Result theirs = run<std::vector<T, CountingAllocator<T>>>(op, n, rounds);
+            records.push_back({op, Elem<T>::name, n, ours, theirs});
+
+            Record const& r = records.back();
+            std::cout << std::left << std::setw(14) << r.op << std::setw(8) << r.type
+                      << std::right << std::setw(11) << r.size
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(11) << ours.ns_per_op << std::setw(11) << theirs.ns_per_op
+                      << std::setw(9) << theirs.ns_per_op / ours.ns_per_op << "x"
+                      << std::setprecision(1)
+                      << std::setw(9) << ours.allocations << std::setw(9) << theirs.allocations
+                      << std::setprecision(0)
+                      << std::setw(14) << ours.realloc_bytes << std::setw(14) << theirs.realloc_bytes
+                      << std::endl;
+        }
+    }
+}
+
+void write_json(std::string const& path, std::vector<Record> const& records) {
+    std::ofstream out(path);
+    auto result = [&out](char const* name, Result const& r) {
+        out << "\"" << name << "\": {\"ns_per_op\": " << r.ns_per_op
+            << ", \"allocations\": " << r.allocations
+            << ", \"realloc_bytes\": " << r.realloc_bytes << "}";
+    };
+    out << std::setprecision(6) << "[\n";
+    for (size_t i = 0; i < records.size(); i++) {
+        Record const& r = records[i];
+        out << "  {\"op\": \"" << r.op << "\", \"type\": \"" << r.type << "\", \"size\": " << r.size << ", ";
+        result("Vectors", r.vectors);
+        out << ", ";
+        result("std::vector", r.std_vector);
+        out << "}" << (i + 1 == records.size() ? "\n" : ",\n");
+    }
+    out << "]\n";
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        if (key == "--max-size") {
+            opt.max_size = std::min<size_t>(std::stod(argv[i + 1]), 100000000);
+        } else if (key == "--min-ops") {
+            opt.min_ops = std::stod(argv[i + 1]);
+        } else if (key == "--mem-budget") {
+            opt.mem_budget = std::stod(argv[i + 1]);
+        } else if (key == "--json") {
+            opt.json = argv[i + 1];
+        } else {
+            std::cerr << "unknown option " << key << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::left << std::setw(14) << "op" << std::setw(8) << "type"
+              << std::right << std::setw(11) << "size"
+              << std::setw(11) << "ns/op" << std::setw(11) << "std ns/op" << std::setw(10) << "speedup"
+              << std::setw(9) << "allocs" << std::setw(9) << "std" << std::setw(14) << "realloc B"
+              << std::setw(14) << "std" << std::endl;
+    std::cout << "-----------------------------" << std::endl;
+
+    std::vector<Record> records;
+    bench_type<int>(opt, records);
+    bench_type<Pod64>(opt, records);
+    bench_type<std::string>(opt, records);
+
+    if (!opt.json.empty()) {
+        write_json(opt.json, records);
+        std::cout << "wrote " << records.size() << " results to " << opt.json << std::endl;
+    }
+    std::cout << "(checksum " << g_sink % 1000 << ")" << std::endl;
+    return 0;
+}
@@ -1,5 +1,62 @@
+#include <array>
+#include <chrono>
+#include <cassert>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
 #include "vectors.hpp"
 
+/* 常量求值: 在编译期生成CRC32查找表 */
+constexpr auto crc_table = materialize([] {
+    Vectors<uint32_t> table;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table.push_back(c);
+    }
+    return table;
+});
+static_assert(crc_table.size() == 256 && crc_table[1] == 0x77073096u && crc_table[255] == 0x2D02EF8Du);
+
+/* 常量求值: 元素本身需要析构和搬迁, 覆盖insert/erase/扩容/拷贝/移动 */
+constexpr int constexpr_nested() {
+    Vectors<Vectors<int>> rows;
+    for (int i = 0; i < 10; i++) {
+        Vectors<int> row(static_cast<size_t>(i), i);
+        rows.insert(rows.begin(), std::move(row));
+    }
+    rows.erase(rows.begin() + 2, rows.begin() + 4);
+    rows.erase_if([](Vectors<int> const& row) { return row.size() % 3 == 0; });
+    Vectors<Vectors<int>> copy = rows;
+    rows = std::move(copy);
+    rows.shrink_to_fit();
+    rows.reserve(100);
+    rows.emplace_back(3, 7);
+    int sum = 0;
+    for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+        for (int x: *it) {
+            sum += x;
+        }
+    }
+    return sum * 100 + static_cast<int>(rows.size());
+}
+/* 保留的行: 8, 5, 4, 2, 1 和新加的 {7, 7, 7} */
+static_assert(constexpr_nested() == (64 + 25 + 16 + 4 + 1 + 21) * 100 + 6);
+
+constexpr size_t constexpr_growth() {
+    Vectors<long, std::allocator<long>, GrowthStats<>> vec;
+    for (long i = 0; i < 1000; i++) {
+        vec.push_back(i);
+    }
+    vec.resize_for_overwrite(2000);
+    vec.erase_indices(std::array<size_t, 2>{0, 1999});
+    return vec.growth_policy().reallocations * 10000 + vec.size();
+}
+static_assert(constexpr_growth() == 12 * 10000 + 1998);
+
 template <class T>
 void printVector(Vectors<T> const& vec, std::string name = "defaultVector") {
     printf("&Vectors of %s: %p\n", name.c_str(), &vec);
@@ -8,6 +65,36 @@ void printVector(Vectors<T> const& vec, std::string name = "defaultVector") {
     }
 }
 
+/**
+ * 统计拷贝和移动次数, 用于检查扩容时是否只做了move
+ */
+template <bool NoexceptMove>
+struct Tracked {
+    static inline int copies = 0, moves = 0, alive = 0;
+    std::string payload;
+
+    explicit Tracked(std::string s) : payload(std::move(s)) { alive++; }
+    Tracked(Tracked const& that) : payload(that.payload) { copies++; alive++; }
+    Tracked(Tracked&& that) noexcept(NoexceptMove) : payload(std::move(that.payload)) { moves++; alive++; }
+    ~Tracked() { alive--; }
+};
+
+/**
+ * 第throw_at次拷贝时抛出异常, move不是noexcept, 扩容只能走拷贝路径
+ */
+struct Fragile {
+    static inline int alive = 0, copies = 0, throw_at = -1;
+    int value;
+
+    explicit Fragile(int v) : value(v) { alive++; }
+    Fragile(Fragile const& that) : value(that.value) {
+        if (++copies == throw_at) throw std::runtime_error("copy");
+        alive++;
+    }
+    Fragile(Fragile&& that) noexcept(false) : value(that.value) { alive++; }
+    ~Fragile() { alive--; }
+};
+
 int main() {
     Vectors<int> arr(15);
     for (int i = 0; i < arr.size(); i++) {
@@ -81,6 +168,216 @@ int main() {
     std::cout << "sizeof(standard_vector): " << sizeof(std::vector<int>) << std::endl;
     std::cout << "-----------------------------" << std::endl;
     
+    /* 非trivially copyable的类型走 move构造 + 析构 的路径 */
+    Vectors<std::string> str_arr{"a", "b", "c", "d"};
+    str_arr.insert(str_arr.begin() + 1, std::string(64, 'x'));
+    str_arr.erase(str_arr.begin() + 2);
+    str_arr.reserve(100);
+    assert(str_arr.size() == 4 && str_arr[1].size() == 64 && str_arr[2] == "c");
+    printVector(str_arr, "str_arr");
+    std::cout << "-----------------------------" << std::endl;
+
+    /* move构造是noexcept时扩容只move, 否则为了强异常安全只能拷贝; 旧元素都需要被析构 */
+    {
+        Vectors<Tracked<true>> moved;
+        Vectors<Tracked<false>> copied;
+        for (int i = 0; i < 100; i++) {
+            moved.emplace_back(std::to_string(i));
+            copied.emplace_back(std::to_string(i));
+        }
+        moved.insert(moved.begin(), moved[50]);
+        moved.shrink_to_fit();
+        std::cout << "noexcept move -> copies: " << Tracked<true>::copies
+                  << " moves: " << Tracked<true>::moves << std::endl;
+        std::cout << "throwing move -> copies: " << Tracked<false>::copies
+                  << " moves: " << Tracked<false>::moves << std::endl;
+        assert(Tracked<true>::copies == 1 && moved[0].payload == "50");
+        assert(Tracked<false>::moves == 0);
+        assert(Tracked<true>::alive == 101 && Tracked<false>::alive == 100);
+    }
+    assert(Tracked<true>::alive == 0 && Tracked<false>::alive == 0);
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 拷贝路径上插入点前后任意一次拷贝抛出异常, 原来的元素都保持不变 */
+    {
+        Fragile extra(-1);
+        for (int throw_at = 1; throw_at <= 16; throw_at++) {
+            Vectors<Fragile> vec;
+            vec.reserve(8);
+            for (int i = 0; i < 8; i++) {
+                vec.emplace_back(i);
+            }
+            // 两种插入都先拷贝一次新元素, 再把8个旧元素拷贝到新内存
+            bool single = throw_at <= 8;
+            Fragile::copies = 0;
+            Fragile::throw_at = single ? throw_at : throw_at - 7;
+            bool thrown = false;
+            try {
+                if (single) {
+                    vec.insert(vec.begin() + 3, extra);
+                } else {
+                    vec.insert(vec.begin() + 5, 2, extra);
+                }
+            } catch (std::runtime_error const&) {
+                thrown = true;
+            }
+            Fragile::throw_at = -1;
+            assert(thrown);
+            assert(vec.size() == 8 && vec.capacity() == 8 && Fragile::alive == 9);
+            for (int i = 0; i < 8; i++) {
+                assert(vec[i].value == i);
+            }
+        }
+
+        // 腾出空位之后构造新元素时抛出异常: 已经构造的新元素被析构, 尾部搬回原处
+        Fragile more[4] = {Fragile(-2), Fragile(-3), Fragile(-4), Fragile(-5)};
+        for (bool grow: {false, true}) {
+            for (int k = 1; k <= 8; k++) {
+                Vectors<Fragile> vec;
+                vec.reserve(grow ? 8 : 16);
+                for (int i = 0; i < 8; i++) {
+                    vec.emplace_back(i);
+                }
+                // 前4次是insert(it, n, val), 先拷贝一次val; 后4次是范围插入; 扩容时还要先拷贝8个旧元素
+                bool fill = k <= 4;
+                Fragile::copies = 0;
+                Fragile::throw_at = (fill ? k + 1 : k - 4) + (grow ? 8 : 0);
+                bool thrown = false;
+                try {
+                    if (fill) {
+                        vec.insert(vec.begin() + 2, 4, extra);
+                    } else {
+                        vec.insert(vec.begin() + 2, more, more + 4);
+                    }
+                } catch (std::runtime_error const&) {
+                    thrown = true;
+                }
+                Fragile::throw_at = -1;
+                assert(thrown && vec.size() == 8 && Fragile::alive == 13);
+                for (int i = 0; i < 8; i++) {
+                    assert(vec[i].value == i);
+                }
+            }
+        }
+        std::cout << "throwing copy: strong guarantee holds, alive " << Fragile::alive << std::endl;
+        assert(Fragile::alive == 5);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 直接把文件读进向量的存储中, 不需要先清零 */
+    {
+        FILE* file = tmpfile();
+        for (int i = 0; i < 1000; i++) {
+            fwrite(&i, sizeof(i), 1, file);
+        }
+        rewind(file);
+
+        Vectors<int> buffer(16, default_init);
+        buffer.resize_for_overwrite(0);
+        size_t total = 0;
+        while (true) {
+            std::span<int> chunk = buffer.append_uninitialized(256);
+            size_t got = fread(chunk.data(), sizeof(int), chunk.size(), file);
+            total += got;
+            buffer.resize(total);
+            if (got < chunk.size()) break;
+        }
+        fclose(file);
+        assert(buffer.size() == 1000 && buffer[999] == 999 && buffer.data()[500] == 500);
+        std::cout << "read " << buffer.size() << " ints, capacity " << buffer.capacity() << std::endl;
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 增长策略与统计 */
+    {
+        Vectors<int, std::allocator<int>, GrowthStats<>> doubling;
+        Vectors<int, std::allocator<int>, GrowthStats<OneAndHalfGrowth>> golden;
+        Vectors<int, std::allocator<int>, GrowthStats<FixedStepGrowth<1000>>> stepped;
+        for (int i = 0; i < 100000; i++) {
+            doubling.push_back(i);
+            golden.push_back(i);
+            stepped.push_back(i);
+        }
+        auto print = [](char const* name, auto const& vec) {
+            auto const& stats = vec.growth_policy();
+            std::cout << name << " reallocations: " << stats.reallocations
+                      << " bytes relocated: " << stats.bytes_relocated
+                      << " peak capacity: " << stats.peak_capacity
+                      << " slack: " << vec.capacity() - vec.size() << std::endl;
+        };
+        print("2x  ", doubling);
+        print("1.5x", golden);
+        print("+1000", stepped);
+        assert(doubling.growth_policy().reallocations == 18 && doubling.capacity() == 131072);
+        assert(golden.growth_policy().peak_slack <= golden.size() / 2);
+        assert(stepped.growth_policy().reallocations == 100 && stepped.capacity() == 100000);
+
+        Vectors<char, std::allocator<char>, PageRoundedGrowth<>> paged;
+        paged.push_back('a');
+        assert(paged.capacity() == 4096);
+
+        /* 用户提供的策略: 每次翻4倍 */
+        auto quadruple = [](size_t capacity, size_t required) { return std::max(required, capacity * 4); };
+        Vectors<int, std::allocator<int>, decltype(quadruple)> custom;
+        for (int i = 0; i < 100; i++) {
+            custom.push_back(i);
+        }
+        assert(custom.capacity() == 256);
+    }
+    std::cout << "-----------------------------" << std::endl;
+
+    /* 一次扫描的批量删除 */
+    {
+        Vectors<int> nums;
+        for (int i = 0; i < 20; i++) {
+            nums.push_back(i);
+        }
+        assert(nums.erase_if([](int x) { return x % 3 == 0; }) == 7);
+        assert(nums.size() == 13 && nums[0] == 1 && nums[1] == 2 && nums[2] == 4 && nums[12] == 19);
+        assert(nums.retain([](int x) { return x < 10; }) == 7 && nums.size() == 6 && nums[5] == 8);
+        nums.push_back(4);
+        assert(nums.remove(nums[2]) == 2 && nums.size() == 5 && nums[2] == 5);
+        size_t indices[] = {0, 2, 2, 4};
+        assert(nums.erase_indices(indices) == 3 && nums.size() == 2);
+        assert(nums[0] == 2 && nums[1] == 7);
+
+        Vectors<std::string> words = {"a", std::string(64, 'b'), "c", std::string(64, 'd'), "e"};
+        assert(words.erase_if([](std::string const& s) { return s.size() > 1; }) == 2);
+        assert(words.size() == 3 && words[0] == "a" && words[1] == "c" && words[2] == "e");
+        size_t first[] = {0};
+        assert(words.erase_indices(first) == 1 && words[0] == "c");
+
+        /* pred抛出异常时剩下的元素仍然连续有效 */
+        words = {"x", "y", "boom", "z"};
+        try {
+            words.erase_if([](std::string const& s) {
+                if (s == "boom") throw std::runtime_error("boom");
+                return s == "x";
+            });
+        } catch (std::runtime_error const&) {}
+        assert(words.size() == 3 && words[0] == "y" && words[1] == "boom" && words[2] == "z");
+
+        /* 过期清理: 2000万个元素中删除10% */
+        size_t n = 20000000;
+        Vectors<long> big(n);
+        std::vector<long> ref(n);
+        for (size_t i = 0; i < n; i++) {
+            big[i] = ref[i] = static_cast<long>(i * 2654435761u % 1000);
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t removed = big.erase_if([](long x) { return x < 100; });
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << "erase_if removed " << removed << " of " << n << " in "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+
+        start = std::chrono::high_resolution_clock::now();
+        ref.erase(std::remove_if(ref.begin(), ref.end(), [](long x) { return x < 100; }), ref.end());
+        end = std::chrono::high_resolution_clock::now();
+        std::cout << "std::remove_if: " << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+        assert(big.size() == ref.size() && std::equal(ref.begin(), ref.end(), big.begin()));
+    }
+    std::cout << "-----------------------------" << std::endl;
+
     arr.resize(0);
     return 0;
 }
\ No newline at end of file